@@ -0,0 +1,111 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "AutoTune.h"
+
+// The search is a Fibonacci search (golden-section search on whole tuner
+// steps): the interval [lo, lo+F(k)] is probed at lo+F(k-2) and
+// lo+F(k-1), and the end beyond the weaker probe is dropped, leaving an
+// interval of width F(k-1) that already holds one probe.  The last
+// probes are +/-1 and +/-2 steps around the best point.
+
+// the RX5808 synthesizer tunes in 2 MHz steps (to odd MHz values)
+#define TUNE_STEP_MHZ 2
+
+static uint16_t tuneLoFreq = 0;        // low end of search interval
+static uint8_t tuneWidth = 0;          // interval width (steps), F(k)
+static uint8_t tunePrevWidth = 0;      //  and F(k-1)
+static uint8_t tuneRssi1 = 0;          // RSSI at lower probe
+static uint8_t tuneRssi2 = 0;          //  and upper probe
+static bool tuneHave1Flag = false;     // true if probe measured
+static bool tuneHave2Flag = false;
+static uint16_t tuneBestFreq = 0;      // best frequency measured
+static uint8_t tuneBestRssi = 0;
+
+
+//Starts a search for the frequency with the highest RSSI within
+// AUTO_TUNE_RANGE_MHZ of the given frequency (whose RSSI is given).
+void startAutoTune(uint16_t centerFreq, uint8_t centerRssi)
+{
+  uint8_t fibA = 1, fibB = 1, fibSum;
+  while (fibB < 2 * AUTO_TUNE_RANGE_MHZ / TUNE_STEP_MHZ)
+  {  //find smallest Fibonacci width covering the range
+    fibSum = fibA + fibB;
+    fibA = fibB;
+    fibB = fibSum;
+  }
+  tuneWidth = fibB;
+  tunePrevWidth = fibA;
+  centerFreq = (centerFreq - 1) | 1;     //frequency actually tuned
+  tuneLoFreq = centerFreq - fibB / 2 * TUNE_STEP_MHZ;
+  if (tuneLoFreq < MIN_CHANNEL_MHZ)
+    tuneLoFreq = MIN_CHANNEL_MHZ + 1;
+  else if (tuneLoFreq + fibB * TUNE_STEP_MHZ > MAX_CHANNEL_MHZ)
+    tuneLoFreq = MAX_CHANNEL_MHZ - fibB * TUNE_STEP_MHZ;
+  tuneHave1Flag = tuneHave2Flag = false;
+  tuneBestFreq = centerFreq;
+  tuneBestRssi = centerRssi;
+}
+
+//Returns the frequency (MHz) to be measured next, or 0 if the search
+// is done.
+uint16_t getAutoTuneProbeFreq()
+{
+  if (tuneWidth <= 2)
+    return 0;
+  if (!tuneHave1Flag)
+    return tuneLoFreq + (tuneWidth - tunePrevWidth) * TUNE_STEP_MHZ;
+  return tuneLoFreq + tunePrevWidth * TUNE_STEP_MHZ;
+}
+
+//Sets the RSSI measured at the frequency returned by
+// 'getAutoTuneProbeFreq()' and narrows the search interval.
+void setAutoTuneProbeRssi(uint8_t rssi)
+{
+  const uint16_t freqVal = getAutoTuneProbeFreq();
+  if (freqVal == 0)
+    return;
+  if (rssi > tuneBestRssi)
+  {
+    tuneBestFreq = freqVal;
+    tuneBestRssi = rssi;
+  }
+  if (!tuneHave1Flag)
+  {
+    tuneRssi1 = rssi;
+    tuneHave1Flag = true;
+  }
+  else
+  {
+    tuneRssi2 = rssi;
+    tuneHave2Flag = true;
+  }
+  if (!tuneHave1Flag || !tuneHave2Flag)
+    return;
+  const uint8_t dropWidth = tuneWidth - tunePrevWidth;     //F(k-2)
+  if (tuneRssi1 < tuneRssi2)
+  {  //drop low end; upper probe becomes lower probe
+    tuneLoFreq += dropWidth * TUNE_STEP_MHZ;
+    tuneRssi1 = tuneRssi2;
+    tuneHave2Flag = false;
+  }
+  else
+  {  //drop high end; lower probe becomes upper probe
+    tuneRssi2 = tuneRssi1;
+    tuneHave1Flag = false;
+  }
+  tuneWidth = tunePrevWidth;
+  tunePrevWidth = dropWidth;
+}
+
+//Returns the frequency (MHz) with the highest RSSI found by the search.
+uint16_t getAutoTuneResultFreq()
+{
+  return tuneBestFreq;
+}
+
+//Returns the RSSI at the frequency found by the search.
+uint8_t getAutoTuneResultRssi()
+{
+  return tuneBestRssi;
+}
@@ -0,0 +1,13 @@
+// AutoTune.h
+
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+void startAutoTune(uint16_t centerFreq, uint8_t centerRssi);
+uint16_t getAutoTuneProbeFreq();
+void setAutoTuneProbeRssi(uint8_t rssi);
+uint16_t getAutoTuneResultFreq();
+uint8_t getAutoTuneResultRssi();
+
+
+#endif /* AUTOTUNE_H_ */
@@ -0,0 +1,96 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "Beeper.h"
+
+// size of beep-pattern queue (must be a power of 2)
+#define BEEP_QUEUE_SIZE 8
+
+// flag in count value for entries that drive the buzzer (not just the LED)
+#define BEEP_SOUND_FLAG 0x80
+
+#define BEEP_PHASE_IDLE 0
+#define BEEP_PHASE_ON 1
+#define BEEP_PHASE_OFF 2
+
+// queued (on, off, count) entries; written by main code, read by interrupt
+static uint16_t beepOnQueue[BEEP_QUEUE_SIZE];
+static uint16_t beepOffQueue[BEEP_QUEUE_SIZE];
+static uint8_t beepCountQueue[BEEP_QUEUE_SIZE];
+static volatile uint8_t beepQueueHead = 0;
+static volatile uint8_t beepQueueTail = 0;
+
+// state of entry currently being played (at queue tail)
+static volatile uint8_t beepPhase = BEEP_PHASE_IDLE;
+static uint16_t beepCountdown = 0;
+static uint8_t beepRepeatsLeft = 0;
+
+static void setBeepOutputs(bool onFlag, bool soundFlag);
+
+
+//Plays the queued beep patterns on the buzzer and LED.  Called from
+// the Timer0 compare-match interrupt (about every 1 ms).
+void beeperTimerTick()
+{
+  if (beepCountdown > 0 && --beepCountdown > 0)
+    return;
+
+  uint8_t tail = beepQueueTail;
+  if (beepPhase == BEEP_PHASE_ON)
+  {  //end of 'on' time; start 'off' time
+    setBeepOutputs(false, false);
+    beepPhase = BEEP_PHASE_OFF;
+    if ((beepCountdown=beepOffQueue[tail]) > 0)
+      return;
+  }
+  if (beepPhase == BEEP_PHASE_OFF)
+  {  //end of 'off' time; repeat or move to next entry
+    if (beepRepeatsLeft > 0)
+      --beepRepeatsLeft;
+    if (beepRepeatsLeft == 0)
+    {
+      tail = (tail + 1) & (BEEP_QUEUE_SIZE - 1);
+      beepQueueTail = tail;
+      beepPhase = BEEP_PHASE_IDLE;
+    }
+  }
+  if (beepPhase == BEEP_PHASE_IDLE)
+  {  //start next entry (if any)
+    if (beepQueueHead == tail)
+      return;
+    beepRepeatsLeft = beepCountQueue[tail] & ~BEEP_SOUND_FLAG;
+  }
+  beepPhase = BEEP_PHASE_ON;
+  if ((beepCountdown=beepOnQueue[tail]) > 0)
+    setBeepOutputs(true, (beepCountQueue[tail] & BEEP_SOUND_FLAG) != 0);
+  else    //no 'on' time (pause only); go to 'off' time on next tick
+    beepCountdown = 1;
+}
+
+//Queues a beep of the given 'on' and 'off' times, repeated the given
+// number of times.  The LED is lit during the 'on' time, and the
+// buzzer is sounded if 'soundFlag' is true.  A zero 'on' time gives a
+// pause.  If the queue is full then the beep is dropped.
+void queueBeep(uint16_t onMs, uint16_t offMs, uint8_t count, bool soundFlag)
+{
+  if (count == 0)
+    return;
+  if (count > BEEP_MAX_COUNT)
+    count = BEEP_MAX_COUNT;
+  const uint8_t head = beepQueueHead;
+  const uint8_t nextHead = (head + 1) & (BEEP_QUEUE_SIZE - 1);
+  if (nextHead != beepQueueTail)
+  {  //entry is filled in before head is advanced, so no need for 'cli()'
+    beepOnQueue[head] = onMs;
+    beepOffQueue[head] = offMs;
+    beepCountQueue[head] = soundFlag ? (count | BEEP_SOUND_FLAG) : count;
+    beepQueueHead = nextHead;
+  }
+}
+
+//Sets the LED and buzzer outputs (buzzer is active low).
+static void setBeepOutputs(bool onFlag, bool soundFlag)
+{
+  digitalWrite(led, onFlag ? HIGH : LOW);
+  digitalWrite(buzzer, (onFlag && soundFlag) ? LOW : HIGH);
+}
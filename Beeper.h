@@ -0,0 +1,13 @@
+// Beeper.h
+
+#ifndef BEEPER_H_
+#define BEEPER_H_
+
+// max repeat count for a queued beep
+#define BEEP_MAX_COUNT 127
+
+void beeperTimerTick();
+void queueBeep(uint16_t onMs, uint16_t offMs, uint8_t count, bool soundFlag);
+
+
+#endif /* BEEPER_H_ */
@@ -0,0 +1,219 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "settings.h"
+#include "Buttons.h"
+
+// size of event queue (must be a power of 2)
+#define BUTTON_QUEUE_SIZE 8
+
+// buttons that auto-repeat while held
+#define BUTTON_REPEAT_MASK ((1 << BTN_UP) | (1 << BTN_DOWN))
+// buttons that report long presses (no release event after long press)
+#define BUTTON_LONG_MASK ((1 << BTN_MODE) | (1 << BTN_SAVE))
+// buttons that are reported as a combination when pressed together
+#define BUTTON_COMBO_MASK ((1 << BTN_UP) | (1 << BTN_DOWN))
+
+#define BUTTON_ID_NONE 0xFF
+
+// pins for buttons, indexed by button ID minus one
+const uint8_t buttonPinsTable[BTN_COUNT] PROGMEM = {
+  buttonUp, buttonMode, buttonDown, buttonSave
+};
+
+static volatile uint8_t buttonEventQueue[BUTTON_QUEUE_SIZE];
+static volatile uint8_t buttonQueueHead = 0;
+static volatile uint8_t buttonQueueTail = 0;
+
+static volatile uint8_t buttonHeldBits = 0;      // debounced state, 1=held
+static uint8_t buttonDebounceCounts[BTN_COUNT + 1];
+static uint8_t buttonSampleTicks = 0;
+
+// state for long-press / auto-repeat of most recently pressed button
+static uint8_t heldButtonId = BUTTON_ID_NONE;
+static uint16_t longPressCountdown = 0;
+static uint8_t repeatCountdown = 0;
+static uint8_t repeatInterval = 0;
+static uint8_t fastRepeatCount = 0;
+static bool longPressSentFlag = false;
+
+// UP or DOWN press held back while waiting to see if the other follows
+static uint8_t comboPendingId = BUTTON_ID_NONE;
+static uint8_t comboCountdown = 0;
+
+static void flushComboPress();
+static void pushButtonEvent(uint8_t evt);
+
+
+//Configures the button pins and enables the Timer0 compare-match
+// interrupt that calls 'buttonsTimerTick()'.  Timer0 also drives
+// 'millis()', so the interrupt fires about once per millisecond.
+void initButtons()
+{
+  for (uint8_t btnId = 1; btnId <= BTN_COUNT; ++btnId)
+    pinMode(pgm_read_byte_near(buttonPinsTable + btnId - 1), INPUT_PULLUP);
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+//Samples and debounces the buttons and generates button events.
+// Called from the Timer0 compare-match interrupt (about every 1 ms).
+void buttonsTimerTick()
+{
+  if (++buttonSampleTicks < BUTTON_SAMPLE_MS)
+    return;
+  buttonSampleTicks = 0;
+
+  for (uint8_t btnId = 1; btnId <= BTN_COUNT; ++btnId)
+  {
+    const uint8_t mask = (uint8_t)1 << btnId;
+    const bool rawHeldFlag =
+       (digitalRead(pgm_read_byte_near(buttonPinsTable + btnId - 1)) == LOW);
+    if (rawHeldFlag == ((buttonHeldBits & mask) != 0))
+    {  //no change from debounced state
+      buttonDebounceCounts[btnId] = 0;
+      continue;
+    }
+    if (++buttonDebounceCounts[btnId] < BUTTON_DEBOUNCE_SAMPLES)
+      continue;
+    buttonDebounceCounts[btnId] = 0;
+
+    if (rawHeldFlag)
+    {  //button pressed; start tracking for long press / auto-repeat
+      buttonHeldBits |= mask;
+      if (BUTTON_COMBO_MASK & mask)
+      {
+        if (comboPendingId != BUTTON_ID_NONE && comboPendingId != btnId)
+        {  //other button of combination pressed within window
+          comboPendingId = BUTTON_ID_NONE;
+          pushButtonEvent(BTN_EV_PRESS | BTN_UP_DOWN);
+          heldButtonId = BTN_UP_DOWN;       //no auto-repeat while held
+          continue;
+        }
+        comboPendingId = btnId;             //report press after window
+        comboCountdown = BUTTON_COMBO_MS;
+      }
+      else
+      {
+        flushComboPress();                  //keep events in order
+        pushButtonEvent(BTN_EV_PRESS | btnId);
+      }
+      heldButtonId = btnId;
+      longPressCountdown = BUTTON_LONG_PRESS_MS;
+      repeatInterval = KEY_DEBOUNCE;
+      repeatCountdown = KEY_DEBOUNCE;
+      fastRepeatCount = 0;
+      longPressSentFlag = false;
+    }
+    else
+    {  //button released
+      buttonHeldBits &= ~mask;
+      if (btnId == comboPendingId)
+        flushComboPress();
+      if (btnId == heldButtonId)
+      {
+        if (!longPressSentFlag)
+          pushButtonEvent(BTN_EV_RELEASE | btnId);
+        heldButtonId = BUTTON_ID_NONE;
+      }
+      else
+        pushButtonEvent(BTN_EV_RELEASE | btnId);
+    }
+  }
+
+  if (comboPendingId != BUTTON_ID_NONE)
+  {  //auto-repeat starts after held-back press is reported
+    if (comboCountdown > BUTTON_SAMPLE_MS)
+    {
+      comboCountdown -= BUTTON_SAMPLE_MS;
+      return;
+    }
+    flushComboPress();
+  }
+
+  if (heldButtonId == BUTTON_ID_NONE)
+    return;
+  const uint8_t mask = (uint8_t)1 << heldButtonId;
+  if (BUTTON_REPEAT_MASK & mask)
+  {  //auto-repeat; interval shortens on each repeat
+    if (repeatCountdown > BUTTON_SAMPLE_MS)
+      repeatCountdown -= BUTTON_SAMPLE_MS;
+    else
+    {
+      if (repeatInterval >= KEY_REPEAT_MIN + KEY_REPEAT_ACCEL)
+        repeatInterval -= KEY_REPEAT_ACCEL;
+      else
+      {
+        repeatInterval = KEY_REPEAT_MIN;
+        if (fastRepeatCount < KEY_REPEAT_FAST_COUNT)
+          ++fastRepeatCount;
+      }
+      repeatCountdown = repeatInterval;
+      pushButtonEvent(((fastRepeatCount < KEY_REPEAT_FAST_COUNT) ?
+                       BTN_EV_REPEAT : BTN_EV_REPEAT_FAST) | heldButtonId);
+    }
+  }
+  else if ((BUTTON_LONG_MASK & mask) && !longPressSentFlag)
+  {
+    if (longPressCountdown > BUTTON_SAMPLE_MS)
+      longPressCountdown -= BUTTON_SAMPLE_MS;
+    else
+    {
+      longPressSentFlag = true;
+      pushButtonEvent(BTN_EV_LONG | heldButtonId);
+    }
+  }
+}
+
+//Returns the next button event and removes it from the queue, or
+// returns BTN_EV_NONE if the queue is empty.
+uint8_t getButtonEvent()
+{
+  const uint8_t tail = buttonQueueTail;
+  if (buttonQueueHead == tail)
+    return BTN_EV_NONE;
+  const uint8_t evt = buttonEventQueue[tail];
+  buttonQueueTail = (tail + 1) & (BUTTON_QUEUE_SIZE - 1);
+  return evt;
+}
+
+//Adds the given event to the button-event queue.  Used for events
+// that do not come from the buttons (like Fatshark button presses
+// received via the serial port).
+void queueButtonEvent(uint8_t evt)
+{
+  const uint8_t oldSREG = SREG;
+  cli();
+  pushButtonEvent(evt);
+  SREG = oldSREG;
+}
+
+//Returns true if the given button is currently held down (debounced).
+bool isButtonHeld(uint8_t btnId)
+{
+  return (buttonHeldBits & ((uint8_t)1 << btnId)) != 0;
+}
+
+//Reports the held-back UP or DOWN press (if any).  Must be called
+// with interrupts disabled.
+static void flushComboPress()
+{
+  if (comboPendingId != BUTTON_ID_NONE)
+  {
+    pushButtonEvent(BTN_EV_PRESS | comboPendingId);
+    comboPendingId = BUTTON_ID_NONE;
+  }
+}
+
+//Adds the given event to the queue.  If the queue is full then the
+// event is dropped.  Must be called with interrupts disabled.
+static void pushButtonEvent(uint8_t evt)
+{
+  const uint8_t head = buttonQueueHead;
+  const uint8_t nextHead = (head + 1) & (BUTTON_QUEUE_SIZE - 1);
+  if (nextHead != buttonQueueTail)
+  {
+    buttonEventQueue[head] = evt;
+    buttonQueueHead = nextHead;
+  }
+}
@@ -0,0 +1,32 @@
+// Buttons.h
+
+#ifndef BUTTONS_H_
+#define BUTTONS_H_
+
+// button IDs (low nibble of event code)
+#define BTN_UP 1
+#define BTN_MODE 2
+#define BTN_DOWN 3
+#define BTN_SAVE 4
+#define BTN_COUNT 4
+#define BTN_UP_DOWN 5   // UP and DOWN pressed together (press event only)
+
+// event types (high nibble of event code)
+#define BTN_EV_NONE 0x00
+#define BTN_EV_PRESS 0x10            // button went down
+#define BTN_EV_RELEASE 0x20          // button went up (not after long press)
+#define BTN_EV_LONG 0x30             // button held for BUTTON_LONG_PRESS_MS
+#define BTN_EV_REPEAT 0x40           // auto-repeat while held
+#define BTN_EV_REPEAT_FAST 0x50      // auto-repeat after reaching max rate
+
+#define BTN_EV_TYPE(evt) ((evt) & 0xF0)
+#define BTN_EV_BUTTON(evt) ((evt) & 0x0F)
+
+void initButtons();
+void buttonsTimerTick();
+uint8_t getButtonEvent();
+void queueButtonEvent(uint8_t evt);
+bool isButtonHeld(uint8_t btnId);
+
+
+#endif /* BUTTONS_H_ */
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "settings.h"
+#include "DivLog.h"
+
+#ifdef USE_DIVERSITY
+
+// upper limit (ms) of each dwell-time bin (last bin has no limit)
+const uint16_t divDwellBinLimits[DIV_DWELL_BINS-1] PROGMEM = {
+  100, 300, 1000, 3000
+};
+
+// antenna-switch event log (ring buffer)
+typedef struct
+{
+  unsigned long timeMs;      // time of switch ('millis()')
+  uint8_t rcvr;              // receiver switched to
+  uint8_t rssiA;             // RSSI (percent) of receivers at switch
+  uint8_t rssiB;
+} DivLogEntry;
+
+static DivLogEntry divLogEntries[DIV_LOG_SIZE];
+static uint8_t divLogHead = 0;       // index for next entry
+static uint8_t divLogCount = 0;      // number of entries in log
+
+static uint16_t divSwitchCount = 0;
+static uint16_t divDwellCounts[DIV_DWELL_BINS];
+
+// switch counts for current and previous one-minute window
+static unsigned long divMinuteStartTime = 0;
+static uint8_t divCurMinuteCount = 0;
+static uint8_t divLastMinuteCount = 0;
+
+static void updateDivMinuteCounts(unsigned long curTime);
+
+
+//Records a switch of the active receiver, with the RSSI values that
+// caused it.  The time the previous receiver was active is added to
+// the dwell-time histogram.
+void logDiversitySwitch(uint8_t newRcvr, uint8_t rssiA, uint8_t rssiB)
+{
+  const unsigned long curTime = millis();
+  if (divLogCount > 0)
+  {  //add dwell time of previous receiver to histogram
+    const unsigned long dwellMs = curTime -
+            divLogEntries[(divLogHead - 1) & (DIV_LOG_SIZE - 1)].timeMs;
+    uint8_t binIdx = 0;
+    while (binIdx < DIV_DWELL_BINS - 1 &&
+               dwellMs >= pgm_read_word_near(divDwellBinLimits + binIdx))
+    {
+      ++binIdx;
+    }
+    if (divDwellCounts[binIdx] < 65535)
+      ++divDwellCounts[binIdx];
+  }
+  DivLogEntry *entPtr = &divLogEntries[divLogHead];
+  entPtr->timeMs = curTime;
+  entPtr->rcvr = newRcvr;
+  entPtr->rssiA = rssiA;
+  entPtr->rssiB = rssiB;
+  divLogHead = (divLogHead + 1) & (DIV_LOG_SIZE - 1);
+  if (divLogCount < DIV_LOG_SIZE)
+    ++divLogCount;
+  if (divSwitchCount < 65535)
+    ++divSwitchCount;
+  updateDivMinuteCounts(curTime);
+  if (divCurMinuteCount < 255)
+    ++divCurMinuteCount;
+}
+
+//Returns the number of antenna switches in the most recent full minute.
+uint8_t getDivSwitchesPerMinute()
+{
+  updateDivMinuteCounts(millis());
+  return divLastMinuteCount;
+}
+
+//Sends the antenna-switch log (oldest first) and statistics to the
+// serial port.
+void printDiversityLog()
+{
+  Serial.println(F("time_ms rcvr rssiA rssiB"));
+  for (uint8_t i = 0; i < divLogCount; ++i)
+  {
+    const DivLogEntry *entPtr = &divLogEntries[
+                        (divLogHead - divLogCount + i) & (DIV_LOG_SIZE - 1)];
+    Serial.print(entPtr->timeMs);
+    Serial.print(' ');
+    Serial.print((char)('A' + entPtr->rcvr - 1));
+    Serial.print(' ');
+    Serial.print(entPtr->rssiA);
+    Serial.print(' ');
+    Serial.println(entPtr->rssiB);
+  }
+  Serial.print(F("switches: "));
+  Serial.print(divSwitchCount);
+  Serial.print(F(", last min: "));
+  Serial.println(getDivSwitchesPerMinute());
+  Serial.print(F("dwell <100 <300 <1000 <3000 more:"));
+  for (uint8_t i = 0; i < DIV_DWELL_BINS; ++i)
+  {
+    Serial.print(' ');
+    Serial.print(divDwellCounts[i]);
+  }
+  Serial.println();
+}
+
+//Moves to new one-minute window(s) for switch counting if time is up.
+static void updateDivMinuteCounts(unsigned long curTime)
+{
+  const unsigned long elapsedMs = curTime - divMinuteStartTime;
+  if (elapsedMs < 60000)
+    return;
+      //if more than one window has passed then previous window was empty
+  divLastMinuteCount = (elapsedMs < 120000) ? divCurMinuteCount : 0;
+  divCurMinuteCount = 0;
+  divMinuteStartTime = curTime - (elapsedMs % 60000);
+}
+
+#endif
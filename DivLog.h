@@ -0,0 +1,21 @@
+// DivLog.h
+
+#ifndef DIVLOG_H_
+#define DIVLOG_H_
+
+#ifdef USE_DIVERSITY
+
+// number of antenna-switch events kept in log (must be a power of 2)
+#define DIV_LOG_SIZE 8
+
+// number of bins in antenna dwell-time histogram
+#define DIV_DWELL_BINS 5
+
+void logDiversitySwitch(uint8_t newRcvr, uint8_t rssiA, uint8_t rssiB);
+uint8_t getDivSwitchesPerMinute();
+void printDiversityLog();
+
+#endif
+
+
+#endif /* DIVLOG_H_ */
@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "settings.h"
+#include "PerfStats.h"
+
+#ifdef USE_PERF_METRICS
+
+// event counts since startup
+static unsigned long perfCounts[PERF_CNT_COUNT];
+
+// timer start times and last/max durations (ms)
+static unsigned long perfTimerStarts[PERF_TMR_COUNT];
+static uint16_t perfTimerLastMs[PERF_TMR_COUNT];
+static uint16_t perfTimerMaxMs[PERF_TMR_COUNT];
+static uint8_t perfTimerRunningBits = 0;
+
+const char perfCntName0[] PROGMEM = "retunes";
+const char perfCntName1[] PROGMEM = "displays";
+const char perfCntName2[] PROGMEM = "eeprom_wr";
+const char * const perfCntNamesTable[PERF_CNT_COUNT] PROGMEM = {
+  perfCntName0, perfCntName1, perfCntName2
+};
+
+const char perfTmrName0[] PROGMEM = "seek_lock";
+const char perfTmrName1[] PROGMEM = "scan_sweep";
+const char * const perfTmrNamesTable[PERF_TMR_COUNT] PROGMEM = {
+  perfTmrName0, perfTmrName1
+};
+
+
+//Increments the given event counter.
+void countPerfEvent(uint8_t cntId)
+{
+  ++perfCounts[cntId];
+}
+
+//Starts (or restarts) the given timer.
+void startPerfTimer(uint8_t tmrId)
+{
+  perfTimerStarts[tmrId] = millis();
+  perfTimerRunningBits |= (uint8_t)1 << tmrId;
+}
+
+//Stops the given timer and records its duration.  Does nothing if the
+// timer is not running.
+void stopPerfTimer(uint8_t tmrId)
+{
+  const uint8_t mask = (uint8_t)1 << tmrId;
+  if ((perfTimerRunningBits & mask) == 0)
+    return;
+  perfTimerRunningBits &= ~mask;
+  const unsigned long durMs = millis() - perfTimerStarts[tmrId];
+  perfTimerLastMs[tmrId] = (durMs < 65535) ? (uint16_t)durMs : 65535;
+  if (perfTimerLastMs[tmrId] > perfTimerMaxMs[tmrId])
+    perfTimerMaxMs[tmrId] = perfTimerLastMs[tmrId];
+}
+
+//Returns the given event count (since startup).
+unsigned long getPerfCount(uint8_t cntId)
+{
+  return perfCounts[cntId];
+}
+
+//Returns the last duration (ms) recorded by the given timer, or 0 if
+// it has not yet been stopped.
+uint16_t getPerfTimerLastMs(uint8_t tmrId)
+{
+  return perfTimerLastMs[tmrId];
+}
+
+//Returns the max duration (ms) recorded by the given timer, or 0 if
+// it has not yet been stopped.
+uint16_t getPerfTimerMaxMs(uint8_t tmrId)
+{
+  return perfTimerMaxMs[tmrId];
+}
+
+//Returns true if the given timer has been started and not yet stopped.
+bool isPerfTimerRunning(uint8_t tmrId)
+{
+  return ((perfTimerRunningBits & ((uint8_t)1 << tmrId)) != 0);
+}
+
+//Sends the event counts (since startup) and the last and max timer
+// durations to the serial port.
+void printPerfStats()
+{
+  for (uint8_t i = 0; i < PERF_CNT_COUNT; ++i)
+  {
+    Serial.print((const __FlashStringHelper *)
+                 pgm_read_ptr_near(perfCntNamesTable + i));
+    Serial.print(F(": "));
+    Serial.println(perfCounts[i]);
+  }
+  Serial.println(F("timer: last_ms max_ms"));
+  for (uint8_t i = 0; i < PERF_TMR_COUNT; ++i)
+  {
+    Serial.print((const __FlashStringHelper *)
+                 pgm_read_ptr_near(perfTmrNamesTable + i));
+    Serial.print(F(": "));
+    Serial.print(perfTimerLastMs[i]);
+    Serial.print(' ');
+    Serial.println(perfTimerMaxMs[i]);
+  }
+}
+
+#endif
@@ -0,0 +1,41 @@
+// PerfStats.h
+
+#ifndef PERFSTATS_H_
+#define PERFSTATS_H_
+
+// event counters
+#define PERF_CNT_RETUNES 0         // tuner set to new frequency
+#define PERF_CNT_DISPLAYS 1        // screen buffer sent to display
+#define PERF_CNT_EEPROM_WRITES 2   // bytes written to EEPROM
+#define PERF_CNT_COUNT 3
+
+// timers (durations in ms)
+#define PERF_TMR_SEEK_LOCK 0       // seek start to channel found
+#define PERF_TMR_SCAN_SWEEP 1      // one full band-scan sweep
+#define PERF_TMR_COUNT 2
+
+#ifdef USE_PERF_METRICS
+
+void countPerfEvent(uint8_t cntId);
+void startPerfTimer(uint8_t tmrId);
+void stopPerfTimer(uint8_t tmrId);
+void printPerfStats();
+unsigned long getPerfCount(uint8_t cntId);
+uint16_t getPerfTimerLastMs(uint8_t tmrId);
+uint16_t getPerfTimerMaxMs(uint8_t tmrId);
+bool isPerfTimerRunning(uint8_t tmrId);
+
+#define PERF_COUNT(cntId) countPerfEvent(cntId)
+#define PERF_START(tmrId) startPerfTimer(tmrId)
+#define PERF_STOP(tmrId) stopPerfTimer(tmrId)
+
+#else
+
+#define PERF_COUNT(cntId)
+#define PERF_START(tmrId)
+#define PERF_STOP(tmrId)
+
+#endif
+
+
+#endif /* PERFSTATS_H_ */
@@ -0,0 +1,45 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "Rx5808Fns.h"
+#include "PreTune.h"
+
+#ifdef USE_PRETUNE
+
+static uint8_t preTuneFreqIdx = 0;             // channel tuned ahead to
+
+
+//Keeps the idle diversity receiver tuned ahead to the given channel
+// index (the likely next channel), or returns it to the video channel
+// if 'nextFreqIdx' is -1.  Called often (via task).
+void updatePreTune(int nextFreqIdx)
+{
+  if (!hasIdleReceiver(IDLE_RCVR_PRETUNE))
+  {  //not tuned ahead (or look-ahead abandoned by channel change)
+    if (nextFreqIdx >= 0 &&
+        takeIdleReceiver(IDLE_RCVR_PRETUNE, (uint8_t)nextFreqIdx))
+    {
+      preTuneFreqIdx = (uint8_t)nextFreqIdx;
+    }
+  }
+  else if (nextFreqIdx != preTuneFreqIdx)
+    returnIdleReceiver();         //look-ahead ended
+}
+
+//If the idle receiver is tuned ahead to the given channel index and has
+// settled then switches the video to it, tunes the other receiver ahead
+// to 'nextFreqIdx' (or to the same channel if -1) and returns true;
+// otherwise returns false (and the channel needs a normal tune).
+bool switchToPreTunedChannel(uint8_t freqIdx, int nextFreqIdx)
+{
+  if (!hasIdleReceiver(IDLE_RCVR_PRETUNE) || freqIdx != preTuneFreqIdx ||
+      !swapIdleReceiver(nextFreqIdx))
+  {
+    return false;
+  }
+  if (nextFreqIdx >= 0)
+    preTuneFreqIdx = (uint8_t)nextFreqIdx;
+  return true;
+}
+
+#endif
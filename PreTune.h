@@ -0,0 +1,14 @@
+// PreTune.h
+
+#ifndef PRETUNE_H_
+#define PRETUNE_H_
+
+#ifdef USE_PRETUNE
+
+void updatePreTune(int nextFreqIdx);
+bool switchToPreTunedChannel(uint8_t freqIdx, int nextFreqIdx);
+
+#endif
+
+
+#endif /* PRETUNE_H_ */
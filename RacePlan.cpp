@@ -0,0 +1,251 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "Rx5808Fns.h"
+#include "ScanResults.h"
+#include "RacePlan.h"
+
+// channel set being built by search (sorted-channel indices and freqs)
+static uint8_t planSortIdx[RACE_PLAN_MAX_PILOTS];
+static uint16_t planFreqs[RACE_PLAN_MAX_PILOTS];
+static uint8_t planPilotCount = 0;
+static uint16_t planReqSpacing = 0;    // min spacing allowed in search
+static uint16_t planMaxSpacing = 0;    // best possible min spacing
+
+// search state for each position in the set: next channel to try, and
+// cost, min spacing and IMD hits of the channels before it
+static uint8_t planPos = 0;
+static bool planRunningFlag = false;
+static uint8_t planNextIdx[RACE_PLAN_MAX_PILOTS];
+static uint16_t planCosts[RACE_PLAN_MAX_PILOTS];
+static uint16_t planSpacings[RACE_PLAN_MAX_PILOTS];
+static uint8_t planImdHits[RACE_PLAN_MAX_PILOTS];
+
+// best channel set found
+static uint8_t bestSortIdx[RACE_PLAN_MAX_PILOTS];
+static uint16_t bestPlanCost = 0xFFFF;
+static uint16_t bestPlanSpacing = 0;
+static uint8_t bestPlanImdHits = 0;
+
+static uint16_t sortIdxToFreq(uint8_t sortIdx);
+static bool isSpacingPossible(uint16_t spacing);
+static bool searchPlanStep();
+static uint8_t countNewImdHits(uint8_t pos);
+static bool isImdNear(int prodFreq, uint16_t chkFreq);
+
+
+//Starts a search for the set of channels for the given number of pilots
+// with the lowest cost, where cost is the measured RSSI on the channels
+// (from the scan results, RACE_PLAN_UNSCANNED_COST if not measured, plus
+// RACE_PLAN_BUSY_PENALTY if occupied), plus RACE_PLAN_IMD_PENALTY per
+// intermodulation product landing on a chosen channel, plus 1 per MHz
+// that the minimum spacing is below the best possible.  Sets with
+// spacing more than RACE_PLAN_SPACING_SLACK below the best possible are
+// not considered, which (with the cost bound) keeps the search short.
+// The search is run by 'updateRacePlan()'.
+void startRacePlan(uint8_t pilotCount)
+{
+  bestPlanCost = 0xFFFF;
+  planRunningFlag = false;
+  if (pilotCount < 1 || pilotCount > RACE_PLAN_MAX_PILOTS)
+    return;
+  planPilotCount = pilotCount;
+
+  // find best possible min spacing (binary search; greedy check)
+  uint16_t loVal = 0;
+  uint16_t hiVal = (pilotCount > 1) ? (sortIdxToFreq(CHANNEL_MAX) -
+                  sortIdxToFreq(CHANNEL_MIN)) / (pilotCount - 1) + 1 : 1;
+  while (hiVal - loVal > 1)
+  {
+    const uint16_t midVal = (loVal + hiVal) / 2;
+    if (isSpacingPossible(midVal))
+      loVal = midVal;
+    else
+      hiVal = midVal;
+  }
+  planMaxSpacing = loVal;
+  planReqSpacing = (planMaxSpacing > RACE_PLAN_SPACING_SLACK) ?
+                        planMaxSpacing - RACE_PLAN_SPACING_SLACK : 1;
+
+  planPos = 0;
+  planNextIdx[0] = CHANNEL_MIN;
+  planCosts[0] = 0;
+  planSpacings[0] = planMaxSpacing;
+  planImdHits[0] = 0;
+  planRunningFlag = true;
+}
+
+//Runs up to RACE_PLAN_STEPS_PER_CALL steps of the search started by
+// 'startRacePlan()', so callers are not held up by a long search.
+// Returns true when the search is done (see 'getRacePlan()').
+bool updateRacePlan()
+{
+  for (uint8_t i = 0; i < RACE_PLAN_STEPS_PER_CALL && planRunningFlag; ++i)
+    planRunningFlag = searchPlanStep();
+  return !planRunningFlag;
+}
+
+//Places the channel indices (in frequency order) of the last plan in
+// the given array.
+// Returns the number of channels (0 if no plan possible).
+uint8_t getRacePlan(uint8_t *freqIdxArr)
+{
+  if (bestPlanCost == 0xFFFF)
+    return 0;
+  for (uint8_t i = 0; i < planPilotCount; ++i)
+    freqIdxArr[i] = getChannelSortTableEntry(bestSortIdx[i]);
+  return planPilotCount;
+}
+
+//Returns the minimum spacing (MHz) between channels of the last plan.
+uint16_t getRacePlanMinSpacing()
+{
+  return bestPlanSpacing;
+}
+
+//Returns the number of intermodulation products landing on channels
+// of the last plan.
+uint8_t getRacePlanImdHits()
+{
+  return bestPlanImdHits;
+}
+
+//Returns the number of third-order intermodulation products (2*f1-f2)
+// of the given frequencies that land within IMD_PRODUCT_MHZ of the
+// given check frequency (which is skipped if in the list).
+uint8_t countImdHitsOnFreq(const uint16_t *freqArr, uint8_t count,
+                                                          uint16_t chkFreq)
+{
+  uint8_t hitCount = 0;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    if (freqArr[i] == chkFreq)
+      continue;
+    for (uint8_t j = 0; j < count; ++j)
+    {
+      if (j != i && freqArr[j] != chkFreq &&
+          isImdNear(2 * (int)freqArr[i] - freqArr[j], chkFreq))
+      {
+        ++hitCount;
+      }
+    }
+  }
+  return hitCount;
+}
+
+//Returns the frequency (MHz) for the given sorted-channel index.
+static uint16_t sortIdxToFreq(uint8_t sortIdx)
+{
+  return getChannelFreqTableEntry(getChannelSortTableEntry(sortIdx));
+}
+
+//Returns true if 'planPilotCount' channels with at least the given
+// spacing can be chosen (taking the lowest channel each time).
+static bool isSpacingPossible(uint16_t spacing)
+{
+  uint8_t chosenCount = 1;
+  uint16_t lastFreq = sortIdxToFreq(CHANNEL_MIN);
+  for (uint8_t i = CHANNEL_MIN + 1; i <= CHANNEL_MAX &&
+                                     chosenCount < planPilotCount; ++i)
+  {
+    const uint16_t freqVal = sortIdxToFreq(i);
+    if (freqVal - lastFreq >= spacing)
+    {
+      lastFreq = freqVal;
+      ++chosenCount;
+    }
+  }
+  return (chosenCount >= planPilotCount);
+}
+
+//Runs one step of the depth-first search for the lowest-cost channel
+// set: tries the next channel at the current position (channels are
+// chosen in frequency order) and moves on to the next position, or
+// backs up when the remaining channels cannot fit.  Sets are pruned when
+// the cost is already too high.
+// Returns false when the search is done.
+static bool searchPlanStep()
+{
+  const uint8_t pos = planPos;
+  const uint8_t i = planNextIdx[pos];
+  const uint8_t leftCount = planPilotCount - pos - 1;
+  if (i > CHANNEL_MAX || sortIdxToFreq(i) + leftCount * planReqSpacing >
+                                                   sortIdxToFreq(CHANNEL_MAX))
+  {  //rest of channels cannot fit; back up to previous position
+    if (pos == 0)
+      return false;
+    --planPos;
+    return true;
+  }
+  planNextIdx[pos] = i + 1;
+  const uint16_t freqVal = sortIdxToFreq(i);
+  const uint16_t minSpacing = planSpacings[pos];
+  uint16_t newSpacing = minSpacing;
+  if (pos > 0)
+  {
+    const uint16_t spacing = freqVal - planFreqs[pos-1];
+    if (spacing < planReqSpacing)
+      return true;
+    if (spacing < newSpacing)
+      newSpacing = spacing;
+  }
+  const uint8_t freqIdx = getChannelSortTableEntry(i);
+  const uint8_t rssi = getScanResult(freqIdx);
+  uint16_t newCost = planCosts[pos] + (minSpacing - newSpacing) +
+                         ((rssi > 0) ? rssi : RACE_PLAN_UNSCANNED_COST);
+  if (isChannelOccupied(freqIdx))
+    newCost += RACE_PLAN_BUSY_PENALTY;
+  if (newCost >= bestPlanCost)
+    return true;             //check before (slower) IMD count
+  planSortIdx[pos] = i;
+  planFreqs[pos] = freqVal;
+  const uint8_t addImdHits = countNewImdHits(pos);
+  newCost += (uint16_t)addImdHits * RACE_PLAN_IMD_PENALTY;
+  if (newCost >= bestPlanCost)
+    return true;
+  const uint8_t newImdHits = planImdHits[pos] + addImdHits;
+  if (leftCount == 0)
+  {  //set complete; cost already checked against best
+    bestPlanCost = newCost;
+    bestPlanSpacing = newSpacing;
+    bestPlanImdHits = newImdHits;
+    for (uint8_t j = 0; j < planPilotCount; ++j)
+      bestSortIdx[j] = planSortIdx[j];
+    return true;
+  }
+  planPos = pos + 1;
+  planNextIdx[pos+1] = i + 1;
+  planCosts[pos+1] = newCost;
+  planSpacings[pos+1] = newSpacing;
+  planImdHits[pos+1] = newImdHits;
+  return true;
+}
+
+//Returns the number of intermodulation hits added when the channel at
+// 'pos' joins the channels before it: its products with each channel
+// that land on another channel, and older products that land on it.
+static uint8_t countNewImdHits(uint8_t pos)
+{
+  const int newFreq = planFreqs[pos];
+  uint8_t hitCount = countImdHitsOnFreq(planFreqs, pos, newFreq);
+  for (uint8_t j = 0; j < pos; ++j)
+  {
+    for (uint8_t k = 0; k < pos; ++k)
+    {
+      if (k == j)
+        continue;
+      if (isImdNear(2 * newFreq - planFreqs[j], planFreqs[k]))
+        ++hitCount;
+      if (isImdNear(2 * (int)planFreqs[j] - newFreq, planFreqs[k]))
+        ++hitCount;
+    }
+  }
+  return hitCount;
+}
+
+//Returns true if the given product frequency is within
+// IMD_PRODUCT_MHZ of the given channel frequency.
+static bool isImdNear(int prodFreq, uint16_t chkFreq)
+{
+  return (abs(prodFreq - (int)chkFreq) <= IMD_PRODUCT_MHZ);
+}
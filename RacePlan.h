@@ -0,0 +1,18 @@
+// RacePlan.h
+
+#ifndef RACEPLAN_H_
+#define RACEPLAN_H_
+
+// max number of pilots (channels) for race-channel planner
+#define RACE_PLAN_MAX_PILOTS 8
+
+void startRacePlan(uint8_t pilotCount);
+bool updateRacePlan();
+uint8_t getRacePlan(uint8_t *freqIdxArr);
+uint16_t getRacePlanMinSpacing();
+uint8_t getRacePlanImdHits();
+uint8_t countImdHitsOnFreq(const uint16_t *freqArr, uint8_t count,
+                                                          uint16_t chkFreq);
+
+
+#endif /* RACEPLAN_H_ */
@@ -0,0 +1,194 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "settings.h"
+#include "RssiCal.h"
+
+// RSSI percent values at the calibration points (min, noise floor,
+// max).  Below the noise floor the RX5808 RSSI output only shows noise,
+// which varies from unit to unit and channel to channel; it is squeezed
+// into the bottom few percent so noise on either receiver reads about
+// the same.  Above the floor the scale is linear, as with 'map()'.
+const uint8_t rssiCurveTable[RSSI_CAL_POINTS] PROGMEM = {
+  1, RSSI_CAL_FLOOR_PCT, 100
+};
+
+// calibration curve for each receiver: raw value at each point, and
+// slope of each segment (percent per raw count, times 256)
+static uint16_t rssiCalRawVals[RSSI_CAL_RCVR_COUNT][RSSI_CAL_POINTS];
+static uint16_t rssiCalSlopes[RSSI_CAL_RCVR_COUNT][RSSI_CAL_POINTS-1];
+
+// noise-floor measurement for each receiver:  readings up to the limit
+// are taken as from empty channels (limit is 0 when not measuring)
+static uint16_t rssiFloorLimits[RSSI_CAL_RCVR_COUNT];
+static uint32_t rssiFloorSums[RSSI_CAL_RCVR_COUNT];
+static uint16_t rssiFloorCounts[RSSI_CAL_RCVR_COUNT];
+
+#ifdef USE_DIVERSITY
+// receiver B minus receiver A RSSI (percent), for each band of levels
+static int8_t rssiMatchOffsets[RSSI_MATCH_BANDS];
+
+// sums of B-A differences measured while matching is active
+static int16_t rssiMatchSums[RSSI_MATCH_BANDS];
+static uint8_t rssiMatchCounts[RSSI_MATCH_BANDS];
+static bool rssiMatchActiveFlag = false;
+
+static uint8_t rssiToMatchBand(uint8_t rssiVal);
+#endif
+
+
+//Builds the calibration curve for the given receiver from the given
+// min, noise-floor and max raw RSSI values (as found by the RSSI setup
+// sweep).  If the floor value is not between min and max (as when it
+// has not been measured) then the curve is a straight line.
+void setRssiCalRange(uint8_t rcvrIdx, uint16_t minVal, uint16_t floorVal,
+                                                        uint16_t maxVal)
+{
+  if (maxVal < minVal + (RSSI_CAL_POINTS-1))     //make sure segments not empty
+    maxVal = minVal + (RSSI_CAL_POINTS-1);
+  if (floorVal <= minVal || floorVal >= maxVal)
+  {  //no floor value; put it on the line from min to max
+    floorVal = minVal + (uint16_t)(((uint32_t)(maxVal - minVal) *
+                                             (RSSI_CAL_FLOOR_PCT - 1)) / 99);
+    if (floorVal <= minVal)
+      floorVal = minVal + 1;
+  }
+  uint16_t *rawValsPtr = rssiCalRawVals[rcvrIdx];
+  uint16_t *slopesPtr = rssiCalSlopes[rcvrIdx];
+  rawValsPtr[0] = minVal;
+  rawValsPtr[1] = floorVal;
+  rawValsPtr[2] = maxVal;
+  for (uint8_t i = 0; i < RSSI_CAL_POINTS-1; ++i)
+  {
+    const uint16_t rise = pgm_read_byte_near(rssiCurveTable + i + 1) -
+                          pgm_read_byte_near(rssiCurveTable + i);
+    slopesPtr[i] = (rise << 8) / (rawValsPtr[i+1] - rawValsPtr[i]);
+  }
+}
+
+//Returns the RSSI percentage (1..100) for the given raw RSSI value,
+// using the calibration curve for the given receiver.
+uint8_t rssiRawToPercent(uint8_t rcvrIdx, uint16_t rawVal)
+{
+  const uint16_t *rawValsPtr = rssiCalRawVals[rcvrIdx];
+  if (rawVal <= rawValsPtr[0])
+    return pgm_read_byte_near(rssiCurveTable);
+  if (rawVal >= rawValsPtr[RSSI_CAL_POINTS-1])
+    return pgm_read_byte_near(rssiCurveTable + RSSI_CAL_POINTS - 1);
+  uint8_t i = RSSI_CAL_POINTS - 2;
+  while (rawVal < rawValsPtr[i])       //find segment containing value
+    --i;
+  return pgm_read_byte_near(rssiCurveTable + i) +
+           (uint8_t)(((rawVal - rawValsPtr[i]) * rssiCalSlopes[rcvrIdx][i]) >> 8);
+}
+
+//Starts measuring the noise floor of the given receiver, using the
+// min and max raw values found so far by the RSSI setup sweep:  the
+// average of readings in the lowest quarter of that range (channels
+// with no transmitter) is taken as the floor.
+void startRssiFloor(uint8_t rcvrIdx, uint16_t minVal, uint16_t maxVal)
+{
+  rssiFloorLimits[rcvrIdx] = (maxVal > minVal) ?
+                                    minVal + (maxVal - minVal) / 4 : minVal;
+  if (rssiFloorLimits[rcvrIdx] == 0)
+    rssiFloorLimits[rcvrIdx] = 1;
+  rssiFloorSums[rcvrIdx] = 0;
+  rssiFloorCounts[rcvrIdx] = 0;
+}
+
+//Adds a raw RSSI reading to the noise-floor measurement for the given
+// receiver.  Does nothing if measuring not started or if the reading is
+// not from an empty channel.
+void addRssiFloorSample(uint8_t rcvrIdx, uint16_t rawVal)
+{
+  if (rssiFloorLimits[rcvrIdx] != 0 && rawVal <= rssiFloorLimits[rcvrIdx] &&
+                                          rssiFloorCounts[rcvrIdx] < 65535)
+  {
+    rssiFloorSums[rcvrIdx] += rawVal;
+    ++rssiFloorCounts[rcvrIdx];
+  }
+}
+
+//Ends the noise-floor measurement for the given receiver and returns
+// the floor (raw value), or 0 if no readings were taken.
+uint16_t finishRssiFloor(uint8_t rcvrIdx)
+{
+  rssiFloorLimits[rcvrIdx] = 0;
+  if (rssiFloorCounts[rcvrIdx] == 0)
+    return 0;
+  return (uint16_t)(rssiFloorSums[rcvrIdx] / rssiFloorCounts[rcvrIdx]);
+}
+
+#ifdef USE_DIVERSITY
+//Starts measuring receiver B against receiver A.  Both receivers must be
+// tuned to the same signal while samples are added (as they are during
+// the RSSI setup sweep).
+void startRssiMatch()
+{
+  for (uint8_t i = 0; i < RSSI_MATCH_BANDS; ++i)
+  {
+    rssiMatchSums[i] = 0;
+    rssiMatchCounts[i] = 0;
+  }
+  rssiMatchActiveFlag = true;
+}
+
+//Adds a pair of RSSI percentages (read at the same time) to the
+// receiver-matching measurement.  Samples are binned by the receiver B
+// value, since that is the value the offset is looked up by (see
+// 'matchRssiBToA()').  Does nothing if matching not started.
+void addRssiMatchSample(uint8_t rssiA, uint8_t rssiB)
+{
+  if (!rssiMatchActiveFlag)
+    return;
+  const uint8_t bandIdx = rssiToMatchBand(rssiB);
+  if (rssiMatchCounts[bandIdx] < 255)
+  {
+    rssiMatchSums[bandIdx] += (int16_t)rssiB - rssiA;
+    ++rssiMatchCounts[bandIdx];
+  }
+}
+
+//Ends the receiver-matching measurement and sets the offset for each
+// band to the average difference measured.  A band with no samples
+// takes the offset of the nearest lower band that has samples (or zero).
+void finishRssiMatch()
+{
+  if (!rssiMatchActiveFlag)
+    return;
+  rssiMatchActiveFlag = false;
+  int8_t offsVal = 0;
+  for (uint8_t i = 0; i < RSSI_MATCH_BANDS; ++i)
+  {
+    if (rssiMatchCounts[i] > 0)
+      offsVal = (int8_t)(rssiMatchSums[i] / rssiMatchCounts[i]);
+    rssiMatchOffsets[i] = offsVal;
+  }
+}
+
+//Returns the receiver B-to-A matching offset for the given band.
+int8_t getRssiMatchOffset(uint8_t bandIdx)
+{
+  return rssiMatchOffsets[bandIdx];
+}
+
+//Sets the receiver B-to-A matching offset for the given band.
+void setRssiMatchOffset(uint8_t bandIdx, int8_t offsVal)
+{
+  rssiMatchOffsets[bandIdx] = offsVal;
+}
+
+//Returns the given receiver B RSSI percentage adjusted to the scale of
+// receiver A (1..100), so the two can be compared directly.
+uint8_t matchRssiBToA(uint8_t rssiB)
+{
+  const int16_t val = (int16_t)rssiB - rssiMatchOffsets[rssiToMatchBand(rssiB)];
+  return (uint8_t)constrain(val, 1, 100);
+}
+
+//Returns the matching-offset band for the given RSSI percentage.
+static uint8_t rssiToMatchBand(uint8_t rssiVal)
+{
+  return (rssiVal > 1) ? (uint8_t)((rssiVal - 1) * RSSI_MATCH_BANDS / 100) : 0;
+}
+#endif
@@ -0,0 +1,40 @@
+// RssiCal.h
+
+#ifndef RSSICAL_H_
+#define RSSICAL_H_
+
+// number of points in RSSI calibration curve (segments + 1):  min,
+// noise floor and max raw values, from the RSSI setup sweep
+#define RSSI_CAL_POINTS 3
+
+// receiver index values for calibration functions
+#define RSSI_CAL_RCVR_A 0
+#ifdef USE_DIVERSITY
+#define RSSI_CAL_RCVR_B 1
+#define RSSI_CAL_RCVR_COUNT 2
+#else
+#define RSSI_CAL_RCVR_COUNT 1
+#endif
+
+#ifdef USE_DIVERSITY
+// number of RSSI-percent bands for receiver B-to-A matching offsets
+#define RSSI_MATCH_BANDS 4
+#endif
+
+void setRssiCalRange(uint8_t rcvrIdx, uint16_t minVal, uint16_t floorVal,
+                                                        uint16_t maxVal);
+uint8_t rssiRawToPercent(uint8_t rcvrIdx, uint16_t rawVal);
+void startRssiFloor(uint8_t rcvrIdx, uint16_t minVal, uint16_t maxVal);
+void addRssiFloorSample(uint8_t rcvrIdx, uint16_t rawVal);
+uint16_t finishRssiFloor(uint8_t rcvrIdx);
+#ifdef USE_DIVERSITY
+void startRssiMatch();
+void addRssiMatchSample(uint8_t rssiA, uint8_t rssiB);
+void finishRssiMatch();
+int8_t getRssiMatchOffset(uint8_t bandIdx);
+void setRssiMatchOffset(uint8_t bandIdx, int8_t offsVal);
+uint8_t matchRssiBToA(uint8_t rssiB);
+#endif
+
+
+#endif /* RSSICAL_H_ */
@@ -0,0 +1,80 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "RssiFilter.h"
+
+#if RSSI_FILTER == RSSI_FILTER_MEDIAN
+static uint16_t medianOfSamples(const uint16_t *samplesPtr, uint8_t count);
+#endif
+
+
+//Clears the given filter (as after the tuner is set to a new channel).
+void resetRssiFilter(RssiFilter *fltPtr)
+{
+  fltPtr->count = 0;
+#if RSSI_FILTER != RSSI_FILTER_EMA
+  fltPtr->nextIdx = 0;
+#endif
+#if RSSI_FILTER == RSSI_FILTER_BOXCAR
+  fltPtr->sampleSum = 0;
+#endif
+}
+
+//Adds a raw ADC sample to the given filter and returns the filtered
+// value.  The update takes constant time (suitable for an interrupt).
+uint16_t updateRssiFilter(RssiFilter *fltPtr, uint16_t sampleVal)
+{
+#if RSSI_FILTER == RSSI_FILTER_EMA
+  if (fltPtr->count == 0)
+  {  //first sample after reset; start filter at sample value
+    fltPtr->emaAccum = sampleVal << RSSI_EMA_SHIFT;
+    fltPtr->count = 1;
+  }
+  else
+    fltPtr->emaAccum += sampleVal - (fltPtr->emaAccum >> RSSI_EMA_SHIFT);
+  return fltPtr->emaAccum >> RSSI_EMA_SHIFT;
+#else
+  const uint8_t idx = fltPtr->nextIdx;
+#if RSSI_FILTER == RSSI_FILTER_BOXCAR
+  if (fltPtr->count >= RSSI_FILTER_TAPS)
+    fltPtr->sampleSum -= fltPtr->samples[idx];     //drop oldest sample
+  fltPtr->sampleSum += sampleVal;
+#endif
+  fltPtr->samples[idx] = sampleVal;
+  fltPtr->nextIdx = (idx < RSSI_FILTER_TAPS - 1) ? idx + 1 : 0;
+  if (fltPtr->count < RSSI_FILTER_TAPS)
+    ++fltPtr->count;
+#if RSSI_FILTER == RSSI_FILTER_BOXCAR
+  return fltPtr->sampleSum / fltPtr->count;
+#else
+  return medianOfSamples(fltPtr->samples, fltPtr->count);
+#endif
+#endif
+}
+
+//Returns true if no samples have been added since the filter was reset.
+bool isRssiFilterEmpty(const RssiFilter *fltPtr)
+{
+  return (fltPtr->count == 0);
+}
+
+#if RSSI_FILTER == RSSI_FILTER_MEDIAN
+//Returns the median of the first 'count' (up to RSSI_FILTER_TAPS)
+// values in the given array.
+static uint16_t medianOfSamples(const uint16_t *samplesPtr, uint8_t count)
+{
+  uint16_t sortBuf[RSSI_FILTER_TAPS];
+  for (uint8_t i = 0; i < count; ++i)
+  {  //insertion sort into buffer
+    const uint16_t val = samplesPtr[i];
+    uint8_t j = i;
+    while (j > 0 && sortBuf[j-1] > val)
+    {
+      sortBuf[j] = sortBuf[j-1];
+      --j;
+    }
+    sortBuf[j] = val;
+  }
+  return sortBuf[count / 2];
+}
+#endif
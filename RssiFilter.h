@@ -0,0 +1,33 @@
+// RssiFilter.h
+
+#ifndef RSSIFILTER_H_
+#define RSSIFILTER_H_
+
+// number of samples held by filter (EMA holds none)
+#if RSSI_FILTER == RSSI_FILTER_BOXCAR
+#define RSSI_FILTER_TAPS RSSI_READS
+#elif RSSI_FILTER == RSSI_FILTER_MEDIAN
+#define RSSI_FILTER_TAPS 5
+#endif
+
+// filter state for one RSSI input
+typedef struct
+{
+#if RSSI_FILTER == RSSI_FILTER_EMA
+  uint16_t emaAccum;         // filtered value times 2^RSSI_EMA_SHIFT
+#else
+  uint16_t samples[RSSI_FILTER_TAPS];   // most recent samples
+  uint8_t nextIdx;           // index in 'samples[]' for next sample
+#endif
+#if RSSI_FILTER == RSSI_FILTER_BOXCAR
+  uint16_t sampleSum;        // sum of values in 'samples[]'
+#endif
+  uint8_t count;             // samples since reset (saturates)
+} RssiFilter;
+
+void resetRssiFilter(RssiFilter *fltPtr);
+uint16_t updateRssiFilter(RssiFilter *fltPtr, uint16_t sampleVal);
+bool isRssiFilterEmpty(const RssiFilter *fltPtr);
+
+
+#endif /* RSSIFILTER_H_ */
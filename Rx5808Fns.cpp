@@ -5,13 +5,34 @@
 
 #include "settings.h"
 #include "Rx5808Fns.h"
+#include "RssiCal.h"
+#include "DivLog.h"
+#include "RssiFilter.h"
+#include "PerfStats.h"
 
 static void setChannelByRegVal(uint16_t regVal);
+static uint16_t regValToFreqMhz(uint16_t regVal);
+static void trackTuneHop(uint16_t *tunedFreqPtr, uint16_t freqVal);
+#ifdef USE_DIVERSITY
+static bool isCrossoverPredicted(int rssiA, int rssiB);
+#endif
 static void SERIAL_SENDBIT1();
 static void SERIAL_SENDBIT0();
 static void SERIAL_ENABLE_LOW();
 static void SERIAL_ENABLE_HIGH();
 
+#ifdef slaveSelectPinB
+// receiver select lines driven by 'setChannelByRegVal()'
+#define SPI_SELECT_A 0x01
+#define SPI_SELECT_B 0x02
+#define SPI_SELECT_BOTH (SPI_SELECT_A | SPI_SELECT_B)
+static uint8_t spi_select_bits = SPI_SELECT_BOTH;
+static void setRcvrChannelByRegVal(uint8_t receiver, uint16_t regVal);
+static void tuneIdleReceiverByRegVal(uint16_t regVal);
+static void checkIdleReceiverReturn();
+static bool isIdleReceiverUsable();
+#endif
+
 
 // Channels to sent to the SPI registers
 const uint16_t channelRegTable[] PROGMEM = {
@@ -46,9 +67,9 @@ const uint16_t channelFreqTable[] PROGMEM = {
 // All Channels of the above List ordered by Mhz
 const uint8_t channelSortTable[] PROGMEM = {
 #ifdef USE_LBAND
-  40, 41, 42, 43, 44, 45, 46, 47, 19, 18, 32, 17, 33, 16, 7, 34, 8, 24, 6, 9, 25, 5, 35, 10, 26, 4, 11, 27, 3, 36, 12, 28, 2, 13, 29, 37, 1, 14, 30, 0, 15, 31, 38, 20, 21, 39, 22, 23
+  40, 41, 42, 43, 44, 45, 46, 47, 19, 32, 18, 17, 33, 16, 7, 34, 8, 24, 6, 9, 25, 5, 35, 10, 26, 4, 11, 27, 3, 36, 12, 28, 2, 13, 29, 37, 1, 14, 30, 0, 15, 31, 38, 20, 21, 39, 22, 23
 #else
-  19, 18, 32, 17, 33, 16, 7, 34, 8, 24, 6, 9, 25, 5, 35, 10, 26, 4, 11, 27, 3, 36, 12, 28, 2, 13, 29, 37, 1, 14, 30, 0, 15, 31, 38, 20, 21, 39, 22, 23
+  19, 32, 18, 17, 33, 16, 7, 34, 8, 24, 6, 9, 25, 5, 35, 10, 26, 4, 11, 27, 3, 36, 12, 28, 2, 13, 29, 37, 1, 14, 30, 0, 15, 31, 38, 20, 21, 39, 22, 23
 #endif
 };
 
@@ -57,6 +78,42 @@ static uint8_t p_rssi = 0;
 static uint8_t p_active_receiver = -1;
 static unsigned long time_screen_saver2 = 0;
 static unsigned long time_of_tune = 0;      // last time when tuner was changed
+static uint8_t tune_settle_ms = MIN_TUNE_TIME;  // wait after last tune
+static uint16_t tune_hop_mhz = 0;           // largest hop since last tune
+static uint16_t tuned_freq_a = 0;           // frequency (MHz) now tuned
+#ifdef slaveSelectPinB
+static uint16_t tuned_freq_b = 0;           //  on each receiver
+#endif
+
+// filters for RSSI samples (reset when tuner changed)
+static RssiFilter rssiFilterA;
+#ifdef USE_DIVERSITY
+static RssiFilter rssiFilterB;
+#endif
+
+#ifdef USE_DIVERSITY
+// filtered RSSI change per sample (x16) for each receiver, and previous
+// RSSI values (for predictive diversity; 0 if no sample since tune)
+static int rssi_slope_a = 0;
+static int rssi_slope_b = 0;
+static uint8_t prev_rssi_a = 0;
+static uint8_t prev_rssi_b = 0;
+#endif
+
+#ifdef slaveSelectPinB
+// channel (register value) last set on both receivers, and receiver
+// temporarily tuned away from it (0 if none); while a receiver is away
+// (or returning) the diversity selection is held and its RSSI value is
+// not updated
+static uint16_t shared_reg_val = 0;
+static uint8_t offchan_receiver = 0;
+static uint16_t offchan_reg_val = 0;        // channel of receiver away
+static uint8_t offchan_owner = 0;           // user that took the receiver
+static bool offchan_return_flag = false;    // tuned back; settling
+static unsigned long offchan_time = 0;      // time receiver last tuned
+static uint16_t last_rssi_raw_a = 0;
+static uint16_t last_rssi_raw_b = 0;
+#endif
 
 extern uint8_t system_state;
 extern uint8_t active_receiver;
@@ -78,7 +135,7 @@ extern char diversity_check_count; // used to decide when to change antennas.
 
 
 #ifdef USE_GC9N_OSD
-void SendToOSD();
+void requestOsdUpdate();
 extern int OSDParams[4];
 #endif
 
@@ -132,7 +189,6 @@ int getIdxForFreqInMhz(uint16_t freqVal)
 uint8_t freqInMhzToNearestFreqIdx(uint16_t freqVal, boolean upFlag)
 {
   int freqIdx, fChkVal = freqVal;
-  uint16_t codeVal;
   do
   {
     freqIdx = getIdxForFreqInMhz(fChkVal);
@@ -157,23 +213,30 @@ uint8_t freqInMhzToNearestFreqIdx(uint16_t freqVal, boolean upFlag)
   return (freqVal < 5800) ? CHANNEL_MIN_INDEX : CHANNEL_MAX_INDEX;
 }
 
-void wait_rssi_ready()
+//Returns true if enough time has passed since the last tune for the
+// RSSI value to be stable.
+bool is_rssi_ready()
 {
-  time_screen_saver2 = millis();
-  // CHECK FOR MINIMUM DELAY
-  // check if RSSI is stable after tune by checking the time
-  uint16_t tune_time = millis() - time_of_tune;
-  if (tune_time < MIN_TUNE_TIME)
-  {
-    // wait until tune time is full filled
-    delay(MIN_TUNE_TIME - tune_time);
-  }
+  return (millis() - time_of_tune >= tune_settle_ms);
 }
 
 // Set time of tune to make sure that RSSI is stable when required.
+// Also clears the RSSI filters and trends (samples are from the previous
+// channel).
 void set_time_of_tune()
 {
   time_of_tune = millis();
+       //wait longer after a bigger hop (slower PLL settle)
+  tune_settle_ms = (tune_hop_mhz >= TUNE_HOP_FAR_MHZ) ? MIN_TUNE_TIME :
+                   MIN_TUNE_TIME_NEAR + (uint8_t)((uint16_t)tune_hop_mhz *
+                   (MIN_TUNE_TIME - MIN_TUNE_TIME_NEAR) / TUNE_HOP_FAR_MHZ);
+  tune_hop_mhz = 0;
+  resetRssiFilter(&rssiFilterA);
+#ifdef USE_DIVERSITY
+  resetRssiFilter(&rssiFilterB);
+  rssi_slope_a = rssi_slope_b = 0;
+  prev_rssi_a = prev_rssi_b = 0;
+#endif
 }
 
 //char * toArray(int number)
@@ -203,28 +266,42 @@ uint16_t readRSSI(char receiver)
 #ifdef USE_DIVERSITY
   int rssiB = 0;
 #endif
-  for (uint8_t i = 0; i < RSSI_READS; i++)
+#ifdef slaveSelectPinB
+  checkIdleReceiverReturn();
+#endif
+  // fill filters after tune; otherwise add a few new samples
+  const uint8_t readCount = isRssiFilterEmpty(&rssiFilterA) ? RSSI_READS :
+                                                    RSSI_READS_PER_CHECK;
+  for (uint8_t i = 0; i < readCount; i++)
   {
+#ifdef slaveSelectPinB
+    if (offchan_receiver != useReceiverA)
+    {
+      analogRead(rssiPinA);
+      last_rssi_raw_a = updateRssiFilter(&rssiFilterA, analogRead(rssiPinA));
+    }
+    if (offchan_receiver != useReceiverB)
+    {
+      analogRead(rssiPinB);
+      last_rssi_raw_b = updateRssiFilter(&rssiFilterB, analogRead(rssiPinB));
+    }
+#else
     analogRead(rssiPinA);
-    rssiA += analogRead(rssiPinA);//random(RSSI_MAX_VAL-200, RSSI_MAX_VAL);//
+    rssiA = updateRssiFilter(&rssiFilterA, analogRead(rssiPinA));
 
 #ifdef USE_DIVERSITY
     analogRead(rssiPinB);
-    rssiB += analogRead(rssiPinB);//random(RSSI_MAX_VAL-200, RSSI_MAX_VAL);//
+    rssiB = updateRssiFilter(&rssiFilterB, analogRead(rssiPinB));
 #endif
-
-
-
-#ifdef Debug
-    rssiB += 1;// random(RSSI_MAX_VAL - 200, RSSI_MAX_VAL); //
 #endif
-
-
   }
-  rssiA = rssiA / RSSI_READS; // average of RSSI_READS readings
+#ifdef slaveSelectPinB
+  rssiA = last_rssi_raw_a;           //receiver tuned away keeps old value
+  rssiB = last_rssi_raw_b;
+#endif
 
-#ifdef USE_DIVERSITY
-  rssiB = rssiB / RSSI_READS; // average of RSSI_READS readings
+#ifdef Debug
+  rssiB += 1;// random(RSSI_MAX_VAL - 200, RSSI_MAX_VAL); //
 #endif
   // special case for RSSI setup
   if (system_state == STATE_RSSI_SETUP)
@@ -237,6 +314,7 @@ uint16_t readRSSI(char receiver)
     {
       rssi_setup_max_a = rssiA;
     }
+    addRssiFloorSample(RSSI_CAL_RCVR_A, rssiA);
 
 #ifdef USE_DIVERSITY
     if (rssiB < rssi_setup_min_b)
@@ -247,25 +325,51 @@ uint16_t readRSSI(char receiver)
     {
       rssi_setup_max_b = rssiB;
     }
+    addRssiFloorSample(RSSI_CAL_RCVR_B, rssiB);
 #endif
   }
 
-  rssiA = map(rssiA, rssi_min_a, rssi_max_a , 1, 100);   // scale from 1..100%
+  rssiA = rssiRawToPercent(RSSI_CAL_RCVR_A, rssiA);   // scale to 1..100%
 #ifdef USE_DIVERSITY
-  rssiB = map(rssiB, rssi_min_b, rssi_max_b , 1, 100);   // scale from 1..100%
+  rssiB = rssiRawToPercent(RSSI_CAL_RCVR_B, rssiB);   // scale to 1..100%
+  if (system_state == STATE_RSSI_SETUP)
+    addRssiMatchSample(rssiA, rssiB);        //measure B against A
+#ifdef slaveSelectPinB
+  if (receiver == -1 && offchan_receiver != 0)
+    receiver = active_receiver;   //no switching while a receiver is away
+#endif
   if (receiver == -1) // no receiver was chosen using diversity
   {
-    switch (diversity_mode)
+    // compare receivers on same scale (B adjusted by matching offsets)
+    const int rssiBMatched = matchRssiBToA(rssiB);
+    // track RSSI trend for each receiver (from second sample after tune)
+    if (prev_rssi_a != 0)
     {
+      rssi_slope_a += (((rssiA - prev_rssi_a) << 4) - rssi_slope_a) >> 2;
+      rssi_slope_b += (((rssiBMatched - prev_rssi_b) << 4) - rssi_slope_b) >> 2;
+    }
+    prev_rssi_a = rssiA;
+    prev_rssi_b = rssiBMatched;
+    if (diversity_mode == useReceiverPredict &&
+        isCrossoverPredicted(rssiA, rssiBMatched))
+    {  //active receiver is fading below the other one; switch now
+      receiver = (active_receiver == useReceiverA) ? useReceiverB :
+                                                     useReceiverA;
+      diversity_check_count = (receiver == useReceiverA) ? 0 :
+                                               DIVERSITY_MAX_CHECKS;
+    }
+    else switch (diversity_mode)
+    {
+      case useReceiverPredict:        //no crossover predicted; same as auto
       case useReceiverAuto:
         // select receiver
-        if ((int)abs((float)(((float)rssiA - (float)rssiB) / (float)rssiB) * 100.0) >= DIVERSITY_CUTOVER)
+        if ((int)abs((float)(((float)rssiA - (float)rssiBMatched) / (float)rssiBMatched) * 100.0) >= DIVERSITY_CUTOVER)
         {
-          if (rssiA > rssiB && diversity_check_count > 0)
+          if (rssiA > rssiBMatched && diversity_check_count > 0)
           {
             diversity_check_count--;
           }
-          if (rssiA < rssiB && diversity_check_count < DIVERSITY_MAX_CHECKS)
+          if (rssiA < rssiBMatched && diversity_check_count < DIVERSITY_MAX_CHECKS)
           {
             diversity_check_count++;
           }
@@ -288,6 +392,8 @@ uint16_t readRSSI(char receiver)
       default:
         receiver = useReceiverA;
     }
+    if (receiver != active_receiver)
+      logDiversitySwitch(receiver, rssiA, rssiB);
     // set the antenna LED and switch the video
     setReceiver(receiver);
   }
@@ -306,7 +412,9 @@ uint16_t readRSSI(char receiver)
 #endif
 
 
-  //SEND RSSI FEEDBACK
+  //SEND RSSI FEEDBACK (after 8 seconds in screen saver)
+  if (system_state != STATE_SCREEN_SAVER)
+    time_screen_saver2 = millis();
   if ( (( time_screen_saver2 != 0 &&  time_screen_saver2 + 8000 < millis()))   && ( system_state == STATE_SCREEN_SAVER) )
   {
     if ((p_active_receiver != active_receiver)  || ((rssi - 60 > p_rssi) ||  (rssi + 60 < p_rssi)))
@@ -317,7 +425,7 @@ uint16_t readRSSI(char receiver)
       OSDParams[1] = rssiB; //rssiB; //this is  B
       OSDParams[2] = receiver; //active_receiver; //CUrrent reciever
       OSDParams[3] = -1; //THIS is for rssi method
-      SendToOSD();
+      requestOsdUpdate();
 #endif
       time_screen_saver2 = 1;
     }
@@ -326,6 +434,40 @@ uint16_t readRSSI(char receiver)
   return constrain(rssi, 1, 100); // clip values to only be within this range.
 }
 
+#ifdef USE_DIVERSITY
+//Returns true if the active receiver's RSSI is falling (at least
+// DIVERSITY_PREDICT_MIN_SLOPE), the other receiver's is not falling that
+// fast (smaller dips are noise), and, projected DIVERSITY_PREDICT_SAMPLES
+// samples ahead, the active RSSI is below the other by at least
+// DIVERSITY_CUTOVER percent.
+static bool isCrossoverPredicted(int rssiA, int rssiB)
+{
+  int actVal, othVal, actSlope, othSlope;
+  if (active_receiver == useReceiverA)
+  {
+    actVal = rssiA;
+    actSlope = rssi_slope_a;
+    othVal = rssiB;
+    othSlope = rssi_slope_b;
+  }
+  else
+  {
+    actVal = rssiB;
+    actSlope = rssi_slope_b;
+    othVal = rssiA;
+    othSlope = rssi_slope_a;
+  }
+  if (actSlope > -DIVERSITY_PREDICT_MIN_SLOPE ||
+      othSlope < -DIVERSITY_PREDICT_MIN_SLOPE)
+    return false;
+  int actPred = (actVal << 4) + actSlope * DIVERSITY_PREDICT_SAMPLES;
+  const int othPred = (othVal << 4) + othSlope * DIVERSITY_PREDICT_SAMPLES;
+  if (actPred < 0)
+    actPred = 0;
+  return (othPred > actPred + actPred / 100 * DIVERSITY_CUTOVER);
+}
+#endif
+
 void setReceiver(uint8_t receiver)
 {
 #ifdef USE_DIVERSITY
@@ -367,13 +509,24 @@ static uint16_t freqMhzToRegVal(uint16_t freqInMhz)
 
 //Convert register value to frequency in MHz
 // FreqMHz = 2*(N*32+A) + 479
-//uint16_t regValToFreqMhz(uint16_t regVal)
-//{
-//  uint16_t N, A;
-//  N = regVal >> 7;
-//  A = regVal & 0x3F;
-//  return 2 * (N*32 + A) + 479;
-//}
+static uint16_t regValToFreqMhz(uint16_t regVal)
+{
+  uint16_t N, A;
+  N = regVal >> 7;
+  A = regVal & 0x7F;
+  return 2 * (N*32 + A) + 479;
+}
+
+//Notes the change of frequency on the given receiver's tuner; the
+// largest hop since the last 'set_time_of_tune()' sets the settle time.
+static void trackTuneHop(uint16_t *tunedFreqPtr, uint16_t freqVal)
+{
+  const uint16_t hopVal = (freqVal > *tunedFreqPtr) ?
+                   freqVal - *tunedFreqPtr : *tunedFreqPtr - freqVal;
+  if (hopVal > tune_hop_mhz)
+    tune_hop_mhz = hopVal;
+  *tunedFreqPtr = freqVal;
+}
 
 
 void setChannelByIdx(uint8_t freqIdx)
@@ -386,10 +539,182 @@ void setChannelByFreq(uint16_t freqInMhz)
   setChannelByRegVal(freqMhzToRegVal(freqInMhz));
 }
 
+#ifdef slaveSelectPinB
+//Tunes receiver A and receiver B to different channels (possible only
+// when receiver B has its own select line).
+void setChannelsByIdx(uint8_t freqIdxA, uint8_t freqIdxB)
+{
+  setRcvrChannelByRegVal(useReceiverA,
+                         pgm_read_word_near(channelRegTable + freqIdxA));
+  setRcvrChannelByRegVal(useReceiverB,
+                         pgm_read_word_near(channelRegTable + freqIdxB));
+}
+
+//Returns the receiver not currently selected for video.
+uint8_t getIdleReceiver()
+{
+  return (active_receiver == useReceiverA) ? useReceiverB : useReceiverA;
+}
+
+//Tunes the idle receiver away to the given channel index for the given
+// user (see 'Rx5808Fns.h'), leaving the active (video) receiver as is,
+// and returns true; returns false (and does nothing) if the idle
+// receiver is in use, the RSSI is not yet stable or the video receiver
+// is not chosen by diversity (see 'isIdleReceiverUsable()').  Diversity
+// switching is held until the receiver is back (via
+// 'returnIdleReceiver()') and settled, or both receivers are tuned.
+bool takeIdleReceiver(uint8_t ownerId, uint8_t freqIdx)
+{
+  checkIdleReceiverReturn();
+  if (offchan_receiver != 0 || !is_rssi_ready() || !isIdleReceiverUsable())
+    return false;
+  offchan_receiver = getIdleReceiver();
+  offchan_owner = ownerId;
+  tuneIdleReceiverByRegVal(pgm_read_word_near(channelRegTable + freqIdx));
+  return true;
+}
+
+//Returns true if the idle receiver is tuned away for the given user (it
+// was taken and has not been returned, and both receivers have not
+// been tuned since).
+bool hasIdleReceiver(uint8_t ownerId)
+{
+  return (offchan_receiver != 0 && !offchan_return_flag &&
+                                                offchan_owner == ownerId);
+}
+
+//Returns true if MIN_TUNE_TIME has passed since the idle receiver was
+// last tuned (so its RSSI is stable).
+bool isIdleReceiverSettled()
+{
+  return (millis() - offchan_time >= MIN_TUNE_TIME);
+}
+
+//If the idle receiver is tuned away and settled then makes it the
+// active (video) receiver, on its channel, tunes the other receiver away
+// to the given channel index (or back to the same channel if -1) and
+// returns true; otherwise (or if a receiver has been chosen in the
+// DIVERSITY menu since) returns false, and the channel needs a normal
+// tune.  Diversity stays held until the receivers are back on the same
+// channel and settled.
+bool swapIdleReceiver(int freqIdx)
+{
+  if (offchan_receiver == 0 || offchan_return_flag ||
+      !isIdleReceiverSettled() || !isIdleReceiverUsable())
+  {
+    return false;
+  }
+  setReceiver(offchan_receiver);
+  shared_reg_val = offchan_reg_val;
+  offchan_receiver = getIdleReceiver();
+  if (freqIdx >= 0)
+    tuneIdleReceiverByRegVal(pgm_read_word_near(channelRegTable + freqIdx));
+  else
+  {
+    tuneIdleReceiverByRegVal(shared_reg_val);
+    offchan_return_flag = true;
+  }
+  return true;
+}
+
+//Tunes the idle receiver (if tuned away) back to the channel of the
+// active receiver.  It is released once it has settled.
+void returnIdleReceiver()
+{
+  if (offchan_receiver == 0 || offchan_return_flag)
+    return;
+  tuneIdleReceiverByRegVal(shared_reg_val);
+  offchan_return_flag = true;
+}
+
+//Returns the RSSI (percent, on receiver A's scale) of the idle receiver,
+// sampled now (without disturbing the filtered values used for
+// diversity).
+uint8_t readIdleReceiverRSSI()
+{
+  const uint8_t rcvr = getIdleReceiver();
+  RssiFilter flt;
+  uint16_t rawVal = 0;
+  resetRssiFilter(&flt);
+  for (uint8_t i = 0; i < RSSI_READS; i++)
+  {
+    const uint8_t pin = (rcvr == useReceiverA) ? rssiPinA : rssiPinB;
+    analogRead(pin);
+    rawVal = updateRssiFilter(&flt, analogRead(pin));
+  }
+  if (rcvr == useReceiverA)
+    return rssiRawToPercent(RSSI_CAL_RCVR_A, rawVal);
+  return matchRssiBToA(rssiRawToPercent(RSSI_CAL_RCVR_B, rawVal));
+}
+
+//Programs only the given receiver; the other one has its select line
+// held high so it ignores the data.
+static void setRcvrChannelByRegVal(uint8_t receiver, uint16_t regVal)
+{
+  if (receiver == useReceiverA)
+  {
+    spi_select_bits = SPI_SELECT_A;
+    digitalWrite(slaveSelectPinB, HIGH);
+  }
+  else
+  {
+    spi_select_bits = SPI_SELECT_B;
+    digitalWrite(slaveSelectPin, HIGH);
+  }
+  setChannelByRegVal(regVal);
+  spi_select_bits = SPI_SELECT_BOTH;
+}
+
+//Tunes the idle receiver (as set in 'offchan_receiver') to the given
+// channel (register value).
+static void tuneIdleReceiverByRegVal(uint16_t regVal)
+{
+  offchan_reg_val = regVal;
+  offchan_return_flag = false;
+  offchan_time = millis();
+  setRcvrChannelByRegVal(offchan_receiver, regVal);
+}
+
+//Returns true if a second receiver is present and the video receiver
+// is chosen by diversity (AUTO or PREDICT), so the idle receiver may be
+// used:  with receiver A or B chosen in the DIVERSITY menu the video
+// must stay on that receiver.
+static bool isIdleReceiverUsable()
+{
+  return (isDiversity() && (diversity_mode == useReceiverAuto ||
+                            diversity_mode == useReceiverPredict));
+}
+
+//Releases the idle receiver if it was returned and has settled.
+static void checkIdleReceiverReturn()
+{
+  if (offchan_return_flag && isIdleReceiverSettled())
+  {
+    offchan_receiver = 0;
+    offchan_return_flag = false;
+  }
+}
+#endif
+
 static void setChannelByRegVal(uint16_t regVal)
 {
   uint8_t i;
 
+#ifdef slaveSelectPinB
+  if (spi_select_bits == SPI_SELECT_BOTH)
+  {  //receivers share channel (any receiver tuned away is now back)
+    shared_reg_val = regVal;
+    offchan_receiver = 0;
+    offchan_return_flag = false;
+  }
+  if (spi_select_bits & SPI_SELECT_A)
+    trackTuneHop(&tuned_freq_a, regValToFreqMhz(regVal));
+  if (spi_select_bits & SPI_SELECT_B)
+    trackTuneHop(&tuned_freq_b, regValToFreqMhz(regVal));
+#else
+  trackTuneHop(&tuned_freq_a, regValToFreqMhz(regVal));
+#endif
+
   // bit bash out 25 bits of data
   // Order: A0-3, !R/W, D0-D19
   // A0=0, A1=0, A2=0, A3=1, RW=0, D0-19=0
@@ -457,9 +782,17 @@ static void setChannelByRegVal(uint16_t regVal)
   delayMicroseconds(1);
   //delay(2);
 
+#ifdef slaveSelectPinB
+  if (spi_select_bits & SPI_SELECT_A)
+    digitalWrite(slaveSelectPin, LOW);
+  if (spi_select_bits & SPI_SELECT_B)
+    digitalWrite(slaveSelectPinB, LOW);
+#else
   digitalWrite(slaveSelectPin, LOW);
+#endif
   digitalWrite(spiClockPin, LOW);
   digitalWrite(spiDataPin, LOW);
+  PERF_COUNT(PERF_CNT_RETUNES);
 }
 
 static void SERIAL_SENDBIT1()
@@ -493,13 +826,27 @@ static void SERIAL_SENDBIT0()
 static void SERIAL_ENABLE_LOW()
 {
   delayMicroseconds(1);
+#ifdef slaveSelectPinB
+  if (spi_select_bits & SPI_SELECT_A)
+    digitalWrite(slaveSelectPin, LOW);
+  if (spi_select_bits & SPI_SELECT_B)
+    digitalWrite(slaveSelectPinB, LOW);
+#else
   digitalWrite(slaveSelectPin, LOW);
+#endif
   delayMicroseconds(1);
 }
 
 static void SERIAL_ENABLE_HIGH()
 {
   delayMicroseconds(1);
+#ifdef slaveSelectPinB
+  if (spi_select_bits & SPI_SELECT_A)
+    digitalWrite(slaveSelectPin, HIGH);
+  if (spi_select_bits & SPI_SELECT_B)
+    digitalWrite(slaveSelectPinB, HIGH);
+#else
   digitalWrite(slaveSelectPin, HIGH);
+#endif
   delayMicroseconds(1);
 }
@@ -3,18 +3,34 @@
 #ifndef RX5808FNS_H_
 #define RX5808FNS_H_
 
+#ifdef slaveSelectPinB
+// users of the idle receiver (see 'takeIdleReceiver()')
+#define IDLE_RCVR_SPOTTER 1
+#define IDLE_RCVR_PRETUNE 2
+#endif
+
 uint8_t getChannelSortTableIndex(uint8_t channelIndex);
 uint8_t getChannelSortTableEntry(int idx);
 uint16_t getChannelFreqTableEntry(int idx);
 int getIdxForFreqInMhz(uint16_t freqVal);
 uint8_t freqInMhzToNearestFreqIdx(uint16_t freqVal, boolean upFlag);
-void wait_rssi_ready();
+bool is_rssi_ready();
 void set_time_of_tune();
 uint16_t readRSSI();
 uint16_t readRSSI(char receiver);
 void setReceiver(uint8_t receiver);
 void setChannelByIdx(uint8_t freqIdx);
 void setChannelByFreq(uint16_t freqInMhz);
+#ifdef slaveSelectPinB
+void setChannelsByIdx(uint8_t freqIdxA, uint8_t freqIdxB);
+uint8_t getIdleReceiver();
+bool takeIdleReceiver(uint8_t ownerId, uint8_t freqIdx);
+bool hasIdleReceiver(uint8_t ownerId);
+bool isIdleReceiverSettled();
+bool swapIdleReceiver(int freqIdx);
+void returnIdleReceiver();
+uint8_t readIdleReceiverRSSI();
+#endif
 
 
 #endif /* RX5808FNS_H_ */
@@ -0,0 +1,441 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "Rx5808Fns.h"
+#include "ScanResults.h"
+
+// latest RSSI (percent) seen on each channel, by channel index
+//  (0 = not yet scanned)
+static uint8_t scanRssiTable[CHANNEL_MAX_INDEX+1];
+
+// RSSI (percent) above which a channel counts as occupied (see
+//  'updateSeekThreshold()')
+static uint8_t seekThreshold = RSSI_SEEK_TRESHOLD;
+
+// channel indices with highest RSSI (best first); only channels above
+//  the seek threshold are listed
+static uint8_t bestIdxList[SCAN_BEST_COUNT];
+static uint8_t bestIdxCount = 0;
+
+// bit per channel index, set if channel flagged as an IMD product
+static uint8_t imdFlagBits[(CHANNEL_MAX_INDEX+8)/8];
+
+// 2-bit revisit score per channel index (nonzero if occupied or changing
+//  recently), and channel index of last revisit
+static uint8_t revisitScoreBits[(CHANNEL_MAX_INDEX+4)/4];
+static uint8_t lastRevisitIdx = 0;
+
+static bool removeFromBestList(uint8_t freqIdx);
+static void insertIntoBestList(uint8_t freqIdx);
+static void refillBestList();
+static uint8_t findCarriers(uint16_t *freqArr, uint8_t minRssi);
+static uint8_t getSortedRssi(char sortIdx);
+static uint16_t getSortedFreq(char sortIdx);
+static uint8_t getRevisitScore(uint8_t freqIdx);
+static void setRevisitScore(uint8_t freqIdx, uint8_t score);
+
+
+//Clears all scan results.
+void clearScanResults()
+{
+  for (uint8_t i = 0; i <= CHANNEL_MAX_INDEX; ++i)
+    scanRssiTable[i] = 0;
+  for (uint8_t i = 0; i < sizeof(imdFlagBits); ++i)
+    imdFlagBits[i] = 0;
+  for (uint8_t i = 0; i < sizeof(revisitScoreBits); ++i)
+    revisitScoreBits[i] = 0;
+  bestIdxCount = 0;
+}
+
+//Records the RSSI (percent) measured on the given channel (from the
+// band scanner, seek or spotter) and updates the best-channels list and
+// the channel's revisit score.
+void addScanResult(uint8_t freqIdx, uint8_t rssi)
+{
+  if (rssi == 0)
+    rssi = 1;                //keep zero for 'not scanned'
+  const bool wasFullFlag = (bestIdxCount >= SCAN_BEST_COUNT);
+  const uint8_t oldRssi = scanRssiTable[freqIdx];
+  scanRssiTable[freqIdx] = rssi;
+  if (rssi > seekThreshold || (oldRssi > 0 &&
+                   abs((int)rssi - (int)oldRssi) >= SCAN_REVISIT_CHANGE))
+  {  //occupied or changing; revisit often
+    setRevisitScore(freqIdx, SCAN_REVISIT_SCORE);
+  }
+  else if (getRevisitScore(freqIdx) > 0)
+    setRevisitScore(freqIdx, getRevisitScore(freqIdx) - 1);
+  if (removeFromBestList(freqIdx) && wasFullFlag && rssi < oldRssi)
+  {  //listed channel dropped; an unlisted channel may now be better
+    refillBestList();
+    return;
+  }
+  if (rssi > seekThreshold)
+    insertIntoBestList(freqIdx);
+}
+
+//Returns the latest RSSI (percent) for the given channel index, or 0 if
+// not yet scanned.
+uint8_t getScanResult(uint8_t freqIdx)
+{
+  return scanRssiTable[freqIdx];
+}
+
+//Fills the given array with up to 'maxCount' channel indices of the
+// highest-RSSI (occupied) channels, best first.
+// Returns the number of entries filled in.
+uint8_t getBestChannels(uint8_t *freqIdxArr, uint8_t maxCount)
+{
+  uint8_t i;
+  for (i = 0; i < maxCount && i < bestIdxCount; ++i)
+    freqIdxArr[i] = bestIdxList[i];
+  return i;
+}
+
+//Returns true if the given channel was last seen with an RSSI above
+// the seek threshold.
+bool isChannelOccupied(uint8_t freqIdx)
+{
+  return (scanRssiTable[freqIdx] > seekThreshold);
+}
+
+//Returns the index of the next scanned-and-unoccupied channel above
+// (or below) the given channel in frequency order, wrapping around the
+// band, or -1 if there is none.
+int getNextFreeChannel(uint8_t freqIdx, bool upFlag)
+{
+  char sortIdx = getChannelSortTableIndex(freqIdx);
+  for (uint8_t i = CHANNEL_MIN; i < CHANNEL_MAX; ++i)
+  {
+    if (upFlag)
+      sortIdx = (sortIdx < CHANNEL_MAX) ? sortIdx + 1 : CHANNEL_MIN;
+    else
+      sortIdx = (sortIdx > CHANNEL_MIN) ? sortIdx - 1 : CHANNEL_MAX;
+    const uint8_t chkIdx = getChannelSortTableEntry(sortIdx);
+    if (scanRssiTable[chkIdx] > 0 && !isChannelOccupied(chkIdx))
+      return chkIdx;
+  }
+  return -1;
+}
+
+//Checks if the RSSI on the given channel matches a third-order
+// intermodulation product (2*f1-f2) of two stronger carriers (peaks in
+// the scan results at least 2*IMD_PRODUCT_MHZ apart), and records the
+// result.  Uses only stored results, so it can run after each channel
+// is scanned.
+// Returns true if the channel is flagged as an IMD product.
+bool checkImdProduct(uint8_t freqIdx)
+{
+  bool flagVal = false;
+  const uint8_t rssi = scanRssiTable[freqIdx];
+  if (rssi >= IMD_DETECT_MIN_RSSI)
+  {
+    uint16_t carrierFreqs[SCAN_MAX_CARRIERS];
+    const uint8_t count = findCarriers(carrierFreqs, rssi);
+    const int chkFreq = getChannelFreqTableEntry(freqIdx);
+    for (uint8_t i = 0; i < count && !flagVal; ++i)
+    {
+      for (uint8_t j = 0; j < count; ++j)
+      {
+        const int diffVal = (int)carrierFreqs[i] - carrierFreqs[j];
+        if (abs(diffVal) >= 2 * IMD_PRODUCT_MHZ &&
+            abs(carrierFreqs[i] + diffVal - chkFreq) <= IMD_PRODUCT_MHZ)
+        {
+          flagVal = true;
+          break;
+        }
+      }
+    }
+  }
+  if (flagVal)
+    imdFlagBits[freqIdx / 8] |= (uint8_t)(1 << (freqIdx % 8));
+  else
+    imdFlagBits[freqIdx / 8] &= (uint8_t)~(1 << (freqIdx % 8));
+  return flagVal;
+}
+
+//Returns true if the given channel was flagged as an IMD product.
+bool isImdProduct(uint8_t freqIdx)
+{
+  return ((imdFlagBits[freqIdx / 8] & (1 << (freqIdx % 8))) != 0);
+}
+
+//Returns the estimated carrier frequency (MHz) of a signal peaking on
+// the given channel, from a parabola fitted (in integer math) through
+// the RSSI of the channel and of its nearest neighbors in frequency.
+// Returns the channel frequency if there is no peak to fit.
+uint16_t estimatePeakFreq(uint8_t freqIdx)
+{
+  const char sortIdx = getChannelSortTableIndex(freqIdx);
+  const uint16_t ctrFreq = getChannelFreqTableEntry(freqIdx);
+  char loIdx = sortIdx - 1;       //skip entries with same frequency
+  while (loIdx >= CHANNEL_MIN && getSortedFreq(loIdx) == ctrFreq)
+    --loIdx;
+  char hiIdx = sortIdx + 1;
+  while (hiIdx <= CHANNEL_MAX && getSortedFreq(hiIdx) == ctrFreq)
+    ++hiIdx;
+  if (loIdx < CHANNEL_MIN || hiIdx > CHANNEL_MAX)
+    return ctrFreq;
+  const long y1 = scanRssiTable[freqIdx];
+  const long dy0 = getSortedRssi(loIdx) - y1;    //neighbor RSSI relative
+  const long dy2 = getSortedRssi(hiIdx) - y1;    // to center
+  if (y1 == 0 || dy0 + y1 == 0 || dy2 + y1 == 0)
+    return ctrFreq;                      //not all scanned
+  const long x0 = (long)getSortedFreq(loIdx) - ctrFreq;    //negative
+  const long x2 = (long)getSortedFreq(hiIdx) - ctrFreq;    //positive
+      //vertex of parabola through (x0,y0), (0,y1), (x2,y2):
+      // (signs flipped so denominator is positive for a peak)
+  const long denVal = 2 * (dy2 * x0 - dy0 * x2);
+  if (denVal <= 0)
+    return ctrFreq;                      //curve not peaked
+  const long numVal = dy2 * x0 * x0 - dy0 * x2 * x2;
+  long offsVal = (numVal + ((numVal >= 0) ? denVal / 2 : -denVal / 2)) /
+                                                        denVal;  //rounded
+  if (offsVal < x0)
+    offsVal = x0;
+  else if (offsVal > x2)
+    offsVal = x2;
+  return ctrFreq + offsVal;
+}
+
+//Returns the RSSI (percent) above which a channel counts as occupied:
+// used by seek for 'found' and for the occupied and best channels here.
+uint8_t getSeekThreshold()
+{
+  return seekThreshold;
+}
+
+//Sets the seek threshold to the noise floor (median RSSI of all
+// channels, from the latest scan results) plus RSSI_SEEK_MARGIN.  The
+// threshold is left as is if there are not enough results.
+void updateSeekThreshold()
+{
+  const uint8_t floorVal = getScanNoiseFloor();
+  if (floorVal == 0)
+    return;
+  const uint16_t thrVal = floorVal + RSSI_SEEK_MARGIN;
+  const uint8_t oldVal = seekThreshold;
+  if (thrVal < RSSI_SEEK_TRESHOLD_MIN)
+    seekThreshold = RSSI_SEEK_TRESHOLD_MIN;
+  else if (thrVal > RSSI_SEEK_TRESHOLD_MAX)
+    seekThreshold = RSSI_SEEK_TRESHOLD_MAX;
+  else
+    seekThreshold = (uint8_t)thrVal;
+  if (seekThreshold != oldVal)
+    refillBestList();          //list entries must be above threshold
+}
+
+//Returns the noise floor, estimated as the median RSSI of the scanned
+// channels (most channels hold no signal), or 0 if fewer than half the
+// channels have been scanned.
+uint8_t getScanNoiseFloor()
+{
+  uint8_t scannedCount = 0;
+  for (uint8_t i = 0; i <= CHANNEL_MAX_INDEX; ++i)
+  {
+    if (scanRssiTable[i] > 0)
+      ++scannedCount;
+  }
+  if (scannedCount < (CHANNEL_MAX_INDEX + 1) / 2)
+    return 0;
+        //binary search for lowest value with half the channels at or below
+  uint8_t loVal = 1, hiVal = 255, midVal, belowCount;
+  while (loVal < hiVal)
+  {
+    midVal = loVal + (hiVal - loVal) / 2;
+    belowCount = 0;
+    for (uint8_t i = 0; i <= CHANNEL_MAX_INDEX; ++i)
+    {
+      if (scanRssiTable[i] > 0 && scanRssiTable[i] <= midVal)
+        ++belowCount;
+    }
+    if (belowCount >= (scannedCount + 1) / 2)
+      hiVal = midVal;
+    else
+      loVal = midVal + 1;
+  }
+  return loVal;
+}
+
+//Returns the index of the next channel (after the last one returned,
+// in turn) that is occupied or has changed recently and should be
+// measured again, or -1 if none.
+int getNextRevisitChannel()
+{
+  uint8_t idx = lastRevisitIdx;
+  for (uint8_t i = 0; i <= CHANNEL_MAX_INDEX; ++i)
+  {
+    if (++idx > CHANNEL_MAX_INDEX)
+      idx = 0;
+    if (getRevisitScore(idx) > 0)
+    {
+      lastRevisitIdx = idx;
+      return idx;
+    }
+  }
+  return -1;
+}
+
+//Updates the given occupied-channels bit array (bit per channel index,
+// OCCUPANCY_BITS_SIZE bytes) from the scan results: the bit is set for
+// an occupied channel that is an RSSI peak (not the skirt of a signal
+// on a neighboring channel) and cleared for other scanned channels;
+// bits for channels not scanned are left as is.
+// Returns true if any bit was changed.
+bool updateOccupancyBits(uint8_t *bitsArr)
+{
+  bool changedFlag = false;
+  for (char sortIdx = CHANNEL_MIN; sortIdx <= CHANNEL_MAX; ++sortIdx)
+  {
+    const uint8_t rssi = getSortedRssi(sortIdx);
+    if (rssi == 0)
+      continue;                //not scanned
+    const bool occFlag = (rssi > seekThreshold &&
+           (sortIdx == CHANNEL_MIN || rssi >= getSortedRssi(sortIdx - 1)) &&
+           (sortIdx == CHANNEL_MAX || rssi >= getSortedRssi(sortIdx + 1)));
+    const uint8_t idx = getChannelSortTableEntry(sortIdx);
+    const uint8_t maskVal = (uint8_t)1 << (idx % 8);
+    if (((bitsArr[idx / 8] & maskVal) != 0) != occFlag)
+    {
+      bitsArr[idx / 8] ^= maskVal;
+      changedFlag = true;
+    }
+  }
+  return changedFlag;
+}
+
+//Returns the revisit score for the given channel index.
+static uint8_t getRevisitScore(uint8_t freqIdx)
+{
+  return (revisitScoreBits[freqIdx / 4] >> ((freqIdx % 4) * 2)) & 0x03;
+}
+
+//Sets the revisit score (0-3) for the given channel index.
+static void setRevisitScore(uint8_t freqIdx, uint8_t score)
+{
+  const uint8_t shiftVal = (freqIdx % 4) * 2;
+  revisitScoreBits[freqIdx / 4] = (revisitScoreBits[freqIdx / 4] &
+                           ~(0x03 << shiftVal)) | (score << shiftVal);
+}
+
+//Sends the scan results (frequency and RSSI of each channel, with '*'
+// marking occupied channels and 'i' IMD products) and the best channels
+// (with estimated carrier frequencies) to the serial port.
+void printScanResults()
+{
+  Serial.println(F("MHz rssi"));
+  for (uint8_t i = CHANNEL_MIN; i <= CHANNEL_MAX; ++i)
+  {
+    const uint8_t idx = getChannelSortTableEntry(i);
+    Serial.print(getChannelFreqTableEntry(idx));
+    Serial.print(' ');
+    Serial.print(scanRssiTable[idx]);
+    if (isChannelOccupied(idx))
+      Serial.print('*');
+    if (isImdProduct(idx))
+      Serial.print('i');
+    Serial.println();
+  }
+  Serial.print(F("best (est MHz):"));
+  for (uint8_t i = 0; i < bestIdxCount; ++i)
+  {
+    Serial.print(' ');
+    Serial.print(getChannelFreqTableEntry(bestIdxList[i]));
+    Serial.print('(');
+    Serial.print(estimatePeakFreq(bestIdxList[i]));
+    Serial.print(')');
+  }
+  Serial.println();
+}
+
+//Removes the given channel from the best-channels list.
+// Returns true if it was in the list.
+static bool removeFromBestList(uint8_t freqIdx)
+{
+  uint8_t i = 0;
+  while (i < bestIdxCount && bestIdxList[i] != freqIdx)
+    ++i;
+  if (i >= bestIdxCount)
+    return false;
+  --bestIdxCount;
+  for (; i < bestIdxCount; ++i)
+    bestIdxList[i] = bestIdxList[i+1];
+  return true;
+}
+
+//Inserts the given channel into the best-channels list (kept sorted by
+// RSSI) if its RSSI is high enough; the lowest entry may drop out.
+static void insertIntoBestList(uint8_t freqIdx)
+{
+  const uint8_t rssi = scanRssiTable[freqIdx];
+  uint8_t i = bestIdxCount;
+  if (i >= SCAN_BEST_COUNT)
+  {  //list full; new entry must beat the last one
+    if (rssi <= scanRssiTable[bestIdxList[SCAN_BEST_COUNT-1]])
+      return;
+    --i;
+  }
+  else
+    ++bestIdxCount;
+  while (i > 0 && scanRssiTable[bestIdxList[i-1]] < rssi)
+  {
+    bestIdxList[i] = bestIdxList[i-1];
+    --i;
+  }
+  bestIdxList[i] = freqIdx;
+}
+
+//Fills the given array with the frequencies of up to SCAN_MAX_CARRIERS
+// carriers: occupied channels with RSSI above the given value that are
+// the strongest within 2*IMD_PRODUCT_MHZ (on a tie the lowest counts).
+// Returns the number of entries filled in.
+static uint8_t findCarriers(uint16_t *freqArr, uint8_t minRssi)
+{
+  uint8_t count = 0;
+  for (char i = CHANNEL_MIN; i <= CHANNEL_MAX && count < SCAN_MAX_CARRIERS;
+                                                                       ++i)
+  {
+    const uint8_t rssi = getSortedRssi(i);
+    if (rssi <= seekThreshold || rssi <= minRssi)
+      continue;
+    const uint16_t freqVal = getSortedFreq(i);
+    bool peakFlag = true;
+    for (char j = i - 1; peakFlag && j >= CHANNEL_MIN &&
+                   freqVal - getSortedFreq(j) <= 2 * IMD_PRODUCT_MHZ; --j)
+    {
+      peakFlag = (rssi > getSortedRssi(j));
+    }
+    for (char j = i + 1; peakFlag && j <= CHANNEL_MAX &&
+                   getSortedFreq(j) - freqVal <= 2 * IMD_PRODUCT_MHZ; ++j)
+    {
+      peakFlag = (rssi >= getSortedRssi(j));
+    }
+    if (peakFlag)
+      freqArr[count++] = freqVal;
+  }
+  return count;
+}
+
+//Returns the RSSI for the given sorted-channel index.
+static uint8_t getSortedRssi(char sortIdx)
+{
+  return scanRssiTable[getChannelSortTableEntry(sortIdx)];
+}
+
+//Returns the frequency (MHz) for the given sorted-channel index.
+static uint16_t getSortedFreq(char sortIdx)
+{
+  return getChannelFreqTableEntry(getChannelSortTableEntry(sortIdx));
+}
+
+//Rebuilds the best-channels list from the whole table (needed only when
+// a listed channel drops and an unlisted one may now qualify, or when
+// the seek threshold changes).
+static void refillBestList()
+{
+  bestIdxCount = 0;
+  for (uint8_t i = 0; i <= CHANNEL_MAX_INDEX; ++i)
+  {
+    if (scanRssiTable[i] > seekThreshold)
+      insertIntoBestList(i);
+  }
+}
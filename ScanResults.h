@@ -0,0 +1,36 @@
+// ScanResults.h
+
+#ifndef SCANRESULTS_H_
+#define SCANRESULTS_H_
+
+// number of best (highest-RSSI) channels tracked
+#define SCAN_BEST_COUNT 4
+
+// max number of carriers (RSSI peaks) used when checking for IMD products
+#define SCAN_MAX_CARRIERS 6
+
+// size of occupied-channels bit array (bit per channel index)
+#define OCCUPANCY_BITS_SIZE ((CHANNEL_MAX_INDEX+8)/8)
+
+// revisit score given to an occupied or changing channel; it drops by one
+//  on each later measurement that is neither (max 3)
+#define SCAN_REVISIT_SCORE 3
+
+void clearScanResults();
+void addScanResult(uint8_t freqIdx, uint8_t rssi);
+uint8_t getScanResult(uint8_t freqIdx);
+uint8_t getBestChannels(uint8_t *freqIdxArr, uint8_t maxCount);
+bool isChannelOccupied(uint8_t freqIdx);
+int getNextFreeChannel(uint8_t freqIdx, bool upFlag);
+bool checkImdProduct(uint8_t freqIdx);
+bool isImdProduct(uint8_t freqIdx);
+uint16_t estimatePeakFreq(uint8_t freqIdx);
+uint8_t getSeekThreshold();
+void updateSeekThreshold();
+uint8_t getScanNoiseFloor();
+int getNextRevisitChannel();
+bool updateOccupancyBits(uint8_t *bitsArr);
+void printScanResults();
+
+
+#endif /* SCANRESULTS_H_ */
@@ -0,0 +1,149 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "SerialCmds.h"
+#include "Buttons.h"
+
+// size of typed-command queue (must be a power of 2)
+#define SERIAL_CMD_QUEUE_SIZE 4
+
+// max value accepted for a typed-command argument
+#define SERIAL_CMD_MAX_VALUE 9999
+
+// typed commands, consumed via 'getSerialCommand()'
+static uint8_t serialCmdCodeQueue[SERIAL_CMD_QUEUE_SIZE];
+static uint16_t serialCmdValueQueue[SERIAL_CMD_QUEUE_SIZE];
+static uint8_t serialCmdQueueHead = 0;
+static uint8_t serialCmdQueueTail = 0;
+
+// typed command currently being received
+static uint8_t pendingCmdCode = SCMD_NONE;
+static uint16_t pendingCmdValue = 0;
+
+static void queueSerialCommand(uint8_t code, uint16_t val);
+static uint8_t cmdLetterToCode(char ch);
+
+
+//Parses bytes received on the serial port (up to
+// SERIAL_MAX_BYTES_PER_POLL per call) and queues the resulting events.
+// The bytes themselves are buffered by the interrupt-driven receive
+// ring buffer in the Arduino core, so nothing is lost between calls.
+// Fatshark button bytes are queued as button-press events (see
+// 'Buttons.h').
+void processSerialInput()
+{
+  uint8_t count = SERIAL_MAX_BYTES_PER_POLL;
+  while (count-- > 0 && Serial.available() > 0)
+  {
+    const char ch = (char)Serial.read();
+    if (ch == '[')
+      queueButtonEvent(BTN_EV_PRESS | BTN_UP);
+    else if (ch == ']')
+      queueButtonEvent(BTN_EV_PRESS | BTN_DOWN);
+    else if (ch >= '0' && ch <= '9')
+    {
+      if (pendingCmdCode != SCMD_NONE)
+      {  //accumulate decimal argument for typed command
+         //(range checked before multiply so value cannot wrap)
+        if (pendingCmdValue > SERIAL_CMD_MAX_VALUE / 10)
+          pendingCmdCode = SCMD_NONE;       //value out of range; discard
+        else
+        {
+          pendingCmdValue = pendingCmdValue * 10 + (ch - '0');
+          if (pendingCmdValue > SERIAL_CMD_MAX_VALUE)
+            pendingCmdCode = SCMD_NONE;     //value out of range; discard
+        }
+      }
+    }
+    else if (ch == '\r' || ch == '\n' || ch == ';')
+    {  //end of typed command
+      if (pendingCmdCode != SCMD_NONE)
+        queueSerialCommand(pendingCmdCode, pendingCmdValue);
+      pendingCmdCode = SCMD_NONE;
+    }
+    else
+    {  //start of new typed command (or unknown byte, which is dropped)
+      pendingCmdCode = cmdLetterToCode(ch);
+      pendingCmdValue = 0;
+    }
+  }
+}
+
+//Returns true if a typed command is waiting to be fetched via
+// 'getSerialCommand()'.
+bool isSerialCommandPending()
+{
+  return (serialCmdQueueHead != serialCmdQueueTail);
+}
+
+//Returns the next queued typed-command code (and its value via the
+// given pointer) and removes it from the queue, or returns SCMD_NONE if
+// the queue is empty.
+uint8_t getSerialCommand(uint16_t *valPtr)
+{
+  if (serialCmdQueueHead == serialCmdQueueTail)
+    return SCMD_NONE;
+  const uint8_t code = serialCmdCodeQueue[serialCmdQueueTail];
+  *valPtr = serialCmdValueQueue[serialCmdQueueTail];
+  serialCmdQueueTail = (serialCmdQueueTail + 1) & (SERIAL_CMD_QUEUE_SIZE - 1);
+  return code;
+}
+
+//Adds the given command to the typed-command queue.  If the queue is
+// full then the command is dropped.
+static void queueSerialCommand(uint8_t code, uint16_t val)
+{
+  const uint8_t nextHead = (serialCmdQueueHead + 1) & (SERIAL_CMD_QUEUE_SIZE - 1);
+  if (nextHead != serialCmdQueueTail)
+  {
+    serialCmdCodeQueue[serialCmdQueueHead] = code;
+    serialCmdValueQueue[serialCmdQueueHead] = val;
+    serialCmdQueueHead = nextHead;
+  }
+}
+
+//Returns the typed-command code for the given command letter, or
+// SCMD_NONE if not a command letter.
+static uint8_t cmdLetterToCode(char ch)
+{
+  switch (ch)
+  {
+    case 'T':
+    case 't':
+      return SCMD_TUNE_MHZ;
+    case 'F':
+    case 'f':
+      return SCMD_SEL_FAV;
+    case 'S':
+    case 's':
+      return SCMD_START_SCAN;
+    case 'A':
+    case 'a':
+      return SCMD_START_SEEK;
+    case 'P':
+    case 'p':
+      return SCMD_TASK_STATS;
+    case 'D':
+    case 'd':
+      return SCMD_DIV_LOG;
+    case 'L':
+    case 'l':
+      return SCMD_SCAN_LIST;
+    case 'N':
+    case 'n':
+      return SCMD_RACE_PLAN;
+    case 'U':
+    case 'u':
+      return SCMD_AUTO_TUNE;
+    case 'M':
+    case 'm':
+      return SCMD_SEEK_MHZ;
+    case 'R':
+    case 'r':
+      return SCMD_FAV_SWEEP;
+    case 'W':
+    case 'w':
+      return SCMD_WATCH_LIST;
+  }
+  return SCMD_NONE;
+}
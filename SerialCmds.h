@@ -0,0 +1,46 @@
+// SerialCmds.h
+
+#ifndef SERIALCMDS_H_
+#define SERIALCMDS_H_
+
+//Serial-input command codes:
+// Fatshark button events are sent by the goggles as single characters
+//  ('[' = up, ']' = down) and are queued as button presses
+// Typed commands are a letter followed by an optional decimal value,
+//  terminated by CR, LF or ';' (for example "T5740" or "F3;"):
+//  T<MHz>  tune to frequency in MHz
+//  F<n>    select favorite slot n (1-based)
+//  S       start band scan
+//  A       start auto seek
+//  P       report task timing (worst-case latency and run time), and
+//           performance metrics if USE_PERF_METRICS is enabled
+//  D       report antenna-switch log and statistics (diversity)
+//  L       list RSSI of all channels (from band scan and spotter)
+//  N<n>    plan race channels for n pilots (default RACE_PLAN_PILOTS)
+//  U       auto fine-tune around current frequency (Set by MHz mode)
+//  M       seek by MHz over full frequency range (Set by MHz mode)
+//  R       rank favorites by RSSI (favorites sweep)
+//  W<mask> watch list of favorites (optional mask: bit 0 = favorite 1)
+#define SCMD_NONE 0
+#define SCMD_TUNE_MHZ 1        // "T<MHz>"
+#define SCMD_SEL_FAV 2         // "F<n>"
+#define SCMD_START_SCAN 3      // "S"
+#define SCMD_START_SEEK 4      // "A"
+#define SCMD_TASK_STATS 5      // "P"
+#define SCMD_DIV_LOG 6         // "D"
+#define SCMD_SCAN_LIST 7       // "L"
+#define SCMD_RACE_PLAN 8       // "N<n>"
+#define SCMD_AUTO_TUNE 9       // "U"
+#define SCMD_SEEK_MHZ 10       // "M"
+#define SCMD_FAV_SWEEP 11      // "R"
+#define SCMD_WATCH_LIST 12     // "W<mask>"
+
+// max number of received bytes parsed per call to 'processSerialInput()'
+#define SERIAL_MAX_BYTES_PER_POLL 16
+
+void processSerialInput();
+bool isSerialCommandPending();
+uint8_t getSerialCommand(uint16_t *valPtr);
+
+
+#endif /* SERIALCMDS_H_ */
@@ -0,0 +1,52 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "Rx5808Fns.h"
+#include "ScanResults.h"
+#include "Spotter.h"
+
+#ifdef USE_SPOTTER
+
+static uint8_t spotSortIdx = CHANNEL_MIN;      // next channel to spot
+static bool spotAwayFlag = false;              // idle receiver taken
+static unsigned long spotTime = 0;             // time last spot ended
+
+
+//Retunes the idle diversity receiver, one channel every
+// SPOTTER_INTERVAL_MS, adding the RSSI on each to the scan results.
+// The video stays on the active receiver while the idle one is away.
+// Called often (via task); 'allowedFlag' false stops spotting.
+void updateSpotter(bool allowedFlag)
+{
+  const unsigned long curTime = millis();
+  if (spotAwayFlag && !hasIdleReceiver(IDLE_RCVR_SPOTTER))
+  {  //both receivers were tuned (channel change); spot abandoned
+    spotAwayFlag = false;
+    spotTime = curTime;
+  }
+  if (!spotAwayFlag)
+  {  //receiver is released MIN_TUNE_TIME after it is returned
+    if (allowedFlag &&
+        curTime - spotTime >= SPOTTER_INTERVAL_MS + MIN_TUNE_TIME &&
+        takeIdleReceiver(IDLE_RCVR_SPOTTER,
+                         getChannelSortTableEntry(spotSortIdx)))
+    {
+      spotAwayFlag = true;
+    }
+    return;
+  }
+  if (allowedFlag)
+  {
+    if (!isIdleReceiverSettled())
+      return;
+    addScanResult(getChannelSortTableEntry(spotSortIdx),
+                  readIdleReceiverRSSI());
+    spotSortIdx = (spotSortIdx < CHANNEL_MAX) ? spotSortIdx + 1 :
+                                                CHANNEL_MIN;
+  }
+  returnIdleReceiver();
+  spotAwayFlag = false;
+  spotTime = curTime;
+}
+
+#endif
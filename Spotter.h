@@ -0,0 +1,13 @@
+// Spotter.h
+
+#ifndef SPOTTER_H_
+#define SPOTTER_H_
+
+#ifdef USE_SPOTTER
+
+void updateSpotter(bool allowedFlag);
+
+#endif
+
+
+#endif /* SPOTTER_H_ */
@@ -0,0 +1,93 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "settings.h"
+#include "Tasks.h"
+
+// task table (in program memory) and number of entries
+static const TaskDef *taskTablePtr = NULL;
+static uint8_t taskTableCount = 0;
+
+// per-task timing; times in ms are low 16 bits of 'millis()'
+static uint16_t taskLastRunTimes[MAX_TASK_COUNT];
+static uint16_t taskMaxLatencies[MAX_TASK_COUNT];   // ms past due time
+static uint16_t taskMaxRunTimes[MAX_TASK_COUNT];    // us per call
+static uint8_t taskMissCounts[MAX_TASK_COUNT];      // calls a period late
+
+static void clearTaskStats();
+
+
+//Sets up the scheduler to run the tasks in the given table (which must
+// be in program memory and have at most MAX_TASK_COUNT entries).
+void initTasks(const TaskDef *tablePtr, uint8_t count)
+{
+  taskTablePtr = tablePtr;
+  taskTableCount = count;
+  const uint16_t curTime = (uint16_t)millis();
+  for (uint8_t i = 0; i < taskTableCount; ++i)
+  {  //setup so all tasks are due on first pass
+    taskLastRunTimes[i] = curTime -
+                  pgm_read_word_near(&taskTablePtr[i].periodMs);
+  }
+  clearTaskStats();
+}
+
+//Makes one pass through the task table, calling each task that is due.
+// Each task runs at most once per pass, in table order, so a task can
+// be delayed by (but never starved by) the others.  Called from 'loop()'.
+void runTasks()
+{
+  for (uint8_t i = 0; i < taskTableCount; ++i)
+  {
+    const uint16_t periodMs = pgm_read_word_near(&taskTablePtr[i].periodMs);
+    const uint16_t startTime = (uint16_t)millis();
+    const uint16_t elapsedMs = startTime - taskLastRunTimes[i];
+    if (elapsedMs < periodMs)
+      continue;
+
+    // track how late the task is (for 'every pass' tasks this is the
+    //  time since the previous call, which is the loop-pass time)
+    const uint16_t latencyMs = elapsedMs - periodMs;
+    if (latencyMs > taskMaxLatencies[i])
+      taskMaxLatencies[i] = latencyMs;
+    if (periodMs > 0 && latencyMs >= periodMs && taskMissCounts[i] < 255)
+      ++taskMissCounts[i];
+    taskLastRunTimes[i] = startTime;
+
+    const unsigned long startUs = micros();
+    ((TaskFnPtr)pgm_read_ptr_near(&taskTablePtr[i].fnPtr))();
+    const unsigned long runUs = micros() - startUs;
+    if (runUs > taskMaxRunTimes[i])
+      taskMaxRunTimes[i] = (runUs < 65535) ? (uint16_t)runUs : 65535;
+  }
+}
+
+//Sends the worst-case latency and run time for each task to the serial
+// port, then clears the values.
+void printTaskStats()
+{
+  Serial.println(F("task: lat_ms run_us miss"));
+  for (uint8_t i = 0; i < taskTableCount; ++i)
+  {
+    Serial.print((const __FlashStringHelper *)
+                 pgm_read_ptr_near(&taskTablePtr[i].namePtr));
+    Serial.print(F(": "));
+    Serial.print(taskMaxLatencies[i]);
+    Serial.print(' ');
+    Serial.print(taskMaxRunTimes[i]);
+    Serial.print(' ');
+    Serial.println(taskMissCounts[i]);
+  }
+  clearTaskStats();
+}
+
+//Clears the per-task latency and run-time values.
+static void clearTaskStats()
+{
+  for (uint8_t i = 0; i < taskTableCount; ++i)
+  {
+    taskMaxLatencies[i] = 0;
+    taskMaxRunTimes[i] = 0;
+    taskMissCounts[i] = 0;
+  }
+}
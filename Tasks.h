@@ -0,0 +1,26 @@
+// Tasks.h
+
+#ifndef TASKS_H_
+#define TASKS_H_
+
+// max number of entries in task table (the table in the main file has
+// 9 with USE_SPOTTER, USE_PRETUNE and USE_GC9N_OSD all enabled; a larger
+// table fails to compile)
+#define MAX_TASK_COUNT 9
+
+typedef void (*TaskFnPtr)();
+
+// task-table entry (table is stored in program memory)
+typedef struct
+{
+  TaskFnPtr fnPtr;           // function called when task is due
+  uint16_t periodMs;         // min time between calls (0 = every pass)
+  const char *namePtr;       // task name (in program memory)
+} TaskDef;
+
+void initTasks(const TaskDef *tablePtr, uint8_t count);
+void runTasks();
+void printTaskStats();
+
+
+#endif /* TASKS_H_ */
@@ -0,0 +1,102 @@
+#include <Arduino.h>
+
+#include "settings.h"
+#include "WatchList.h"
+
+static bool isWatchSampled(uint8_t pos);
+
+// filtered RSSI (times 2^WATCH_FILTER_SHIFT) and min/max RSSI for each
+// watched channel
+static uint16_t watchRssiAccum[WATCH_MAX_CHANNELS];
+static uint8_t watchMinRssi[WATCH_MAX_CHANNELS];
+static uint8_t watchMaxRssi[WATCH_MAX_CHANNELS];
+static uint16_t watchSampledBits = 0;    // bit set if channel has samples
+
+static unsigned long watchRoundTime = 0; // time last round started (0 =
+static uint16_t watchRefreshMs = 0;      //  none) and time it took
+
+
+//Clears the values for all channels and the refresh time.
+void resetWatchList()
+{
+  watchSampledBits = 0;
+  watchRoundTime = 0;
+  watchRefreshMs = 0;
+}
+
+//Clears the values for the given channel (as when it is added to the
+// list).
+void resetWatchChannel(uint8_t pos)
+{
+  watchSampledBits &= ~((uint16_t)1 << pos);
+}
+
+//Adds an RSSI sample (percent) for the given channel, updating its
+// filtered value and min/max.
+void addWatchSample(uint8_t pos, uint8_t rssi)
+{
+  if (pos >= WATCH_MAX_CHANNELS)
+    return;
+  const uint16_t bitVal = (uint16_t)1 << pos;
+  if ((watchSampledBits & bitVal) == 0)
+  {  //first sample; start filter at sample value
+    watchSampledBits |= bitVal;
+    watchRssiAccum[pos] = (uint16_t)rssi << WATCH_FILTER_SHIFT;
+    watchMinRssi[pos] = watchMaxRssi[pos] = rssi;
+    return;
+  }
+  watchRssiAccum[pos] += rssi - (watchRssiAccum[pos] >> WATCH_FILTER_SHIFT);
+  if (rssi < watchMinRssi[pos])
+    watchMinRssi[pos] = rssi;
+  if (rssi > watchMaxRssi[pos])
+    watchMaxRssi[pos] = rssi;
+}
+
+//Marks the start of a round of the watched channels; the time since the
+// previous round is the refresh time of each channel.
+void markWatchRound()
+{
+  const unsigned long curTime = millis();
+  if (watchRoundTime != 0)
+    watchRefreshMs = (uint16_t)(curTime - watchRoundTime);
+  watchRoundTime = curTime;
+}
+
+//Returns the filtered RSSI (percent) for the given channel, or 0 if it
+// has not been sampled.
+uint8_t getWatchRssi(uint8_t pos)
+{
+  if (!isWatchSampled(pos))
+    return 0;
+  return (uint8_t)(watchRssiAccum[pos] >> WATCH_FILTER_SHIFT);
+}
+
+//Returns the lowest RSSI sampled for the given channel (0 if none).
+uint8_t getWatchMinRssi(uint8_t pos)
+{
+  if (!isWatchSampled(pos))
+    return 0;
+  return watchMinRssi[pos];
+}
+
+//Returns the highest RSSI sampled for the given channel (0 if none).
+uint8_t getWatchMaxRssi(uint8_t pos)
+{
+  if (!isWatchSampled(pos))
+    return 0;
+  return watchMaxRssi[pos];
+}
+
+//Returns the time (ms) taken by the last round of the watched channels
+// (how often each is refreshed), or 0 if no round is done yet.
+uint16_t getWatchRefreshMs()
+{
+  return watchRefreshMs;
+}
+
+//Returns true if the given channel has been sampled.
+static bool isWatchSampled(uint8_t pos)
+{
+  return (pos < WATCH_MAX_CHANNELS &&
+                        (watchSampledBits & ((uint16_t)1 << pos)) != 0);
+}
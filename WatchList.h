@@ -0,0 +1,19 @@
+// WatchList.h
+
+#ifndef WATCHLIST_H_
+#define WATCHLIST_H_
+
+// number of channels that can be watched (one per favorites slot)
+#define WATCH_MAX_CHANNELS 10
+
+void resetWatchList();
+void resetWatchChannel(uint8_t pos);
+void addWatchSample(uint8_t pos, uint8_t rssi);
+void markWatchRound();
+uint8_t getWatchRssi(uint8_t pos);
+uint8_t getWatchMinRssi(uint8_t pos);
+uint8_t getWatchMaxRssi(uint8_t pos);
+uint16_t getWatchRefreshMs();
+
+
+#endif /* WATCHLIST_H_ */
@@ -29,6 +29,8 @@
 #include <avr/pgmspace.h>
 #ifdef OLED_128x64_ADAFRUIT_SCREENS
 #include "screens.h" // function headers
+#include "PerfStats.h"
+#include "ScanResults.h"
  
 #include "Adafruit_SSD1306.h"
  
@@ -73,9 +75,10 @@ screens::screens()
   best_rssi = 0;
   bestChannelName = 0;
   bestChannelFrequency = 0;
+  displayDirtyFlag = false;
 }
  
-char screens::begin(const char *call_sign)
+char screens::begin(const char * /*call_sign*/)
 {
  
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);  // initialize with the I2C addr 0x3D or 0x3C (for the 128x64)
@@ -95,6 +98,26 @@ char screens::begin(const char *call_sign)
   return 0; // no errors
 }
  
+//Returns true if the screen has been drawn to since the last
+// 'flush()' (the display does not yet show the changes).
+bool screens::isDirty()
+{
+  return displayDirtyFlag;
+}
+
+//Sends the screen buffer to the display if it has been drawn to since
+// the last flush.  Screens only draw into the buffer, so several
+// updates between flushes cost a single (slow) transfer.
+void screens::flush()
+{
+  if (displayDirtyFlag)
+  {
+    displayDirtyFlag = false;
+    display.display();
+    PERF_COUNT(PERF_CNT_DISPLAYS);
+  }
+}
+ 
 void screens::reset()
 {
   display.clearDisplay();
@@ -155,6 +178,10 @@ void screens::mainMenuSecondPage(uint8_t menu_id, bool settings_OSD)
   display.setCursor(5, 10 * 2 + 13);
   display.print(PSTR2("FIND MODEL"));
 
+  display.setTextColor(menu_id == 4 ? BLACK : WHITE);
+  display.setCursor(5, 10 * 4 + 13);
+  display.print(PSTR2("WATCH LIST"));
+
 #ifdef USE_GC9N_OSD
   display.setTextColor(menu_id == 3 ? BLACK : WHITE);
   display.setCursor(5, 10 * 3 + 13);
@@ -163,9 +190,11 @@ void screens::mainMenuSecondPage(uint8_t menu_id, bool settings_OSD)
     display.print(PSTR2("ON "));
   else 
     display.print(PSTR2("OFF"));
+#else
+  (void)settings_OSD;        // no OSD item
 #endif
 
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::mainMenu(uint8_t menu_id)
@@ -192,7 +221,7 @@ void screens::mainMenu(uint8_t menu_id)
   display.print(PSTR2("FAVORITES"));
   display.print(PSTR2("         "));
   display.write(25);         // display down-arrow symbol
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::seekMode(uint8_t state)
@@ -234,7 +263,7 @@ void screens::seekMode(uint8_t state)
   display.print(PSTR2("5800"));
   display.setCursor(display.width() - 25, display.height() - 9);
   display.print(PSTR2("5945"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::FavDelete( uint16_t channelFrequency, uint8_t channel)
@@ -253,7 +282,7 @@ void screens::FavDelete( uint16_t channelFrequency, uint8_t channel)
  
   display.setCursor(((display.width() - 11 * 6) / 2), 8 * 6 + 4);
   display.print(PSTR2("-- DELETED --"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::FavSel(uint8_t favchan) 
@@ -265,7 +294,7 @@ void screens::FavSel(uint8_t favchan)
   display.setCursor(20, 20);
   display.print(favchan);
   
-  display.display();
+  displayDirtyFlag = true;
   reset();
 }
  
@@ -287,6 +316,42 @@ void screens::FavSel(uint8_t favchan)
 //  delay(1500);
 //}
  
+void screens::favSweep(uint8_t count, const uint8_t *favNums, const uint16_t *freqs, const uint8_t *rssis, uint8_t selPos)
+{
+  reset(); // start from fresh screen.
+  drawTitleBox(PSTR2("FAVORITES BY RSSI"));
+  if (count == 0)
+  {  //first sweep not done yet
+    display.setCursor(5, 8 * 3 + 4);
+    display.print(PSTR2("SWEEPING..."));
+    displayDirtyFlag = true;
+    return;
+  }
+  // strongest first; five per column: "fav# MHz rssi"
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const uint8_t xPos = (i < 5) ? 3 : 66;
+    const uint8_t yPos = 10 * (i % 5) + 13;
+    if (i == selPos)
+    {
+      display.fillRect(xPos - 1, yPos - 1, 61, 10, WHITE);
+      display.setTextColor(BLACK);
+    }
+    else
+      display.setTextColor(WHITE);
+    display.setCursor(xPos, yPos);
+    if (favNums[i] < 10)
+      display.print(' ');
+    display.print(favNums[i]);
+    display.print(' ');
+    display.print(freqs[i]);
+    display.print(' ');
+    display.print((rssis[i] < 100) ? rssis[i] : 99);
+  }
+  display.setTextColor(WHITE);
+  displayDirtyFlag = true;
+}
+
 void screens::NoFav()
 {
   reset(); // start from fresh screen.
@@ -296,7 +361,7 @@ void screens::NoFav()
   display.setTextColor(WHITE);
   display.setCursor(20, 20);
   display.print(PSTR2("EMPTY"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
 char scan_position = 3;
@@ -405,7 +470,7 @@ void screens::updateSeekMode(uint8_t state, uint8_t channelIndex, uint8_t channe
   }
  
   last_channel = channel;
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::bandScanMode(uint8_t state)
@@ -439,9 +504,130 @@ void screens::bandScanMode(uint8_t state)
   display.print(PSTR2("5800"));
   display.setCursor(display.width() - 25, display.height() - 9);
   display.print(PSTR2("5945"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
+void screens::bandScanSweepDone()
+{
+  // show best channel from sweep just done and setup to look for new
+  //  best-RSSI channel
+  best_rssi = 0;
+  if (bestChannelName > 0)
+  {  //new best-RSSI channel was found
+    display.setTextColor(WHITE, BLACK);
+    display.setCursor(36, 12);
+    display.print((char)(bestChannelName >> 8));    //band char
+    display.print((char)(bestChannelName & 0xFF));  //channel char
+    display.setCursor(52, 12);
+    display.print(bestChannelFrequency);
+    bestChannelName = 0;
+    bestChannelFrequency = 0;
+    displayDirtyFlag = true;
+  }
+}
+
+void screens::updateBandScanImdFlag(uint8_t channel, bool imdFlag)
+{
+  // mark above spectrum bar for channel that is an IMD product
+#ifdef USE_LBAND
+  display.fillRect((channel * 5 / 2) + 4, display.height() - 12 - 31, 5 / 2, 1, imdFlag ? WHITE : BLACK);
+#else
+  display.fillRect((channel * 3) + 4, display.height() - 12 - 31, 3, 1, imdFlag ? WHITE : BLACK);
+#endif
+  displayDirtyFlag = true;
+}
+
+void screens::updateBandScanBar(uint8_t channel, uint8_t rssi)
+{
+  // redraw spectrum bar only (channel measured again out of sweep order)
+  uint8_t rssi_scaled = map(rssi, 1, 100, 1, 30);
+  uint16_t hight = (display.height() - 12 - rssi_scaled);
+#ifdef USE_LBAND
+  display.fillRect((channel * 5 / 2) + 4, display.height() - 12 - 30, 5 / 2, 30 - rssi_scaled, BLACK);
+  display.fillRect((channel * 5 / 2) + 4, hight, 5 / 2, rssi_scaled, WHITE);
+#else
+  display.fillRect((channel * 3) + 4, display.height() - 12 - 30, 3, 30 - rssi_scaled, BLACK);
+  display.fillRect((channel * 3) + 4, hight, 3, rssi_scaled, WHITE);
+#endif
+  displayDirtyFlag = true;
+}
+
+void screens::racePlan(uint8_t count, const uint16_t *channelNames, const uint16_t *channelFreqs, uint16_t minSpacing, uint8_t imdHits)
+{
+  reset(); // start from fresh screen.
+  drawTitleBox(PSTR2("RACE CHANNEL PLAN"));
+  if (count == 0)
+  {
+    display.setCursor(5, 8 * 3 + 4);
+    display.print(PSTR2("NO PLAN POSSIBLE"));
+    displayDirtyFlag = true;
+    return;
+  }
+  // two channels per line, in frequency order
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    display.setCursor((i & 1) ? 68 : 5, 8 * (i / 2) + 14);
+    display.print((char)(channelNames[i] >> 8));     //band char
+    display.print((char)(channelNames[i] & 0xFF));   //channel char
+    display.print(' ');
+    display.print(channelFreqs[i]);
+  }
+  display.setCursor(5, display.height() - 10);
+  display.print(PSTR2("MIN SPACE "));
+  display.print(minSpacing);
+  display.print(PSTR2("  IMD "));
+  display.print(imdHits);
+  displayDirtyFlag = true;
+}
+
+void screens::watchList(uint8_t count, const uint8_t *rssis, const uint8_t *minRssis, const uint8_t *maxRssis, uint16_t watchMask, uint8_t selPos, uint16_t refreshMs)
+{
+#define WATCH_BAR_TOP 14
+#define WATCH_BAR_HEIGHT 37
+  reset(); // start from fresh screen.
+  drawTitleBox(PSTR2("WATCH LIST"), false);
+  if (refreshMs > 0)
+  {  //time for each channel to be refreshed
+    display.setTextColor(BLACK);
+    display.setCursor(display.width() - 6 * 6 - 2, 2);
+    if (refreshMs < 1000)
+      display.print(' ');
+    display.print(refreshMs);
+    display.print(PSTR2("MS"));
+    display.setTextColor(WHITE);
+  }
+  // one bar per watched favorite (on a base line), with min/max marks
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const uint8_t xPos = 12 * i + 5;
+    if (watchMask & ((uint16_t)1 << i))
+    {
+      display.drawFastHLine(xPos, WATCH_BAR_TOP + WATCH_BAR_HEIGHT, 8, WHITE);
+      uint8_t barHeight = map(rssis[i], 0, 100, 0, WATCH_BAR_HEIGHT);
+      display.fillRect(xPos, WATCH_BAR_TOP + WATCH_BAR_HEIGHT - barHeight, 8, barHeight, WHITE);
+      barHeight = map(maxRssis[i], 0, 100, 0, WATCH_BAR_HEIGHT);
+      display.drawFastHLine(xPos, WATCH_BAR_TOP + WATCH_BAR_HEIGHT - barHeight, 8, INVERT);
+      if (minRssis[i] != maxRssis[i])
+      {
+        barHeight = map(minRssis[i], 0, 100, 0, WATCH_BAR_HEIGHT);
+        display.drawFastHLine(xPos, WATCH_BAR_TOP + WATCH_BAR_HEIGHT - barHeight, 8, INVERT);
+      }
+    }
+    // favorite number (inverted at cursor)
+    if (i == selPos)
+    {
+      display.fillRect(xPos - 2, 53, 12, 10, WHITE);
+      display.setTextColor(BLACK);
+    }
+    else
+      display.setTextColor(WHITE);
+    display.setCursor((i < 9) ? xPos + 1 : xPos - 2, 54);
+    display.print(i + 1);
+  }
+  display.setTextColor(WHITE);
+  displayDirtyFlag = true;
+}
+
 void screens::updateBandScanMode(bool in_setup, uint8_t channel, uint8_t rssi, uint16_t channelName, uint16_t channelFrequency, uint16_t rssi_setup_min_a, uint16_t rssi_setup_max_a)
 {
 #define SCANNER_LIST_X_POS 60
@@ -464,25 +650,7 @@ void screens::updateBandScanMode(bool in_setup, uint8_t channel, uint8_t rssi, u
   }
   if (!in_setup)
   {
-    // if scan started new sweep then show best channel from last sweep
-    //  and setup to look for new best-RSSI channel
-    if (channel < last_channel)
-    {
-      best_rssi = 0;
-      if (bestChannelName > 0)
-      {  //new best-RSSI channel was found
-        display.setTextColor(WHITE, BLACK);
-        display.setCursor(36, 12);
-        display.print((char)(bestChannelName >> 8));    //band char
-        display.print((char)(bestChannelName & 0xFF));  //channel char
-        display.setCursor(52, 12);
-        display.print(bestChannelFrequency);
-        bestChannelName = 0;
-        bestChannelFrequency = 0;
-      }
-    }
-
-    if (rssi > RSSI_SEEK_TRESHOLD)
+    if (rssi > getSeekThreshold())
     {
       if (rssi > best_rssi)
       {
@@ -513,7 +681,7 @@ void screens::updateBandScanMode(bool in_setup, uint8_t channel, uint8_t rssi, u
     display.print( PSTR2("   ") );
     display.print( rssi_setup_max_a , DEC);
   }
-  display.display();
+  displayDirtyFlag = true;
   last_channel = channel;
 }
  
@@ -577,6 +745,9 @@ void screens::screenSaver(uint8_t diversity_mode, uint16_t channelName, uint16_t
       case useReceiverB:
         display.print(PSTR2("ANT B"));
         break;
+      case useReceiverPredict:
+        display.print(PSTR2("PRED"));
+        break;
     }
   }
 #endif
@@ -591,9 +762,21 @@ void screens::screenSaver(uint8_t diversity_mode, uint16_t channelName, uint16_t
   display.fillRect(0, display.height() - 13, 7, 13, WHITE);
   display.setCursor(1, display.height() - 11);
   display.print(PSTR2("B"));  
-  display.display();
+  displayDirtyFlag = true;
 }
  
+void screens::screenSaverAutoTune(int offsetMhz)
+{
+  display.setTextSize(1);
+  display.setTextColor(WHITE, BLACK);
+  display.setCursor(64, 28);
+  display.print(PSTR2("AFC "));
+  if (offsetMhz > 0)
+    display.print('+');
+  display.print(offsetMhz);
+  displayDirtyFlag = true;
+}
+
 void screens::updateScreenSaver(uint8_t rssi)
 {
   updateScreenSaver(-1, rssi, -1, -1 );
@@ -660,6 +843,7 @@ void screens::updateScreenSaver(char active_receiver, uint8_t rssi, uint8_t rssi
         display.fillRect(0, display.height() - 27, 25, 19, WHITE);
         display.setCursor(1, display.height() - 13);
         display.print(PSTR2("RSSI"));
+    #undef RSSI_BAR_SIZE
     #define RSSI_BAR_SIZE 101
         uint8_t rssi_scaled = map(rssi, 1, 100, 1, RSSI_BAR_SIZE);
         display.fillRect(25 + rssi_scaled, display.height() - 19, (RSSI_BAR_SIZE - rssi_scaled), 19, BLACK);
@@ -689,7 +873,7 @@ void screens::updateScreenSaver(char active_receiver, uint8_t rssi, uint8_t rssi
 
   }
    
-  display.display();
+  displayDirtyFlag = true;
 }
  
 #ifdef USE_DIVERSITY
@@ -699,19 +883,22 @@ void screens::diversity(uint8_t diversity_mode)
   reset();
   drawTitleBox(PSTR2("DIVERSITY"));
  
-  //selected
-  display.fillRect(0, 10 * diversity_mode + 12, display.width(), 10, WHITE);
+  //selected (rows are 8 pixels to fit four items above RSSI bars)
+  display.fillRect(0, 8 * diversity_mode + 11, display.width(), 8, WHITE);
  
   display.setTextColor(diversity_mode == useReceiverAuto ? BLACK : WHITE);
-  display.setCursor(5, 10 * 1 + 3);
+  display.setCursor(5, 8 * 0 + 12);
   display.print(PSTR2("AUTO"));
  
   display.setTextColor(diversity_mode == useReceiverA ? BLACK : WHITE);
-  display.setCursor(5, 10 * 2 + 3);
+  display.setCursor(5, 8 * 1 + 12);
   display.print(PSTR2("RECEIVER A"));
   display.setTextColor(diversity_mode == useReceiverB ? BLACK : WHITE);
-  display.setCursor(5, 10 * 3 + 3);
+  display.setCursor(5, 8 * 2 + 12);
   display.print(PSTR2("RECEIVER B"));
+  display.setTextColor(diversity_mode == useReceiverPredict ? BLACK : WHITE);
+  display.setCursor(5, 8 * 3 + 12);
+  display.print(PSTR2("PREDICTIVE"));
  
   // RSSI Strength
   display.setTextColor(WHITE);
@@ -720,12 +907,21 @@ void screens::diversity(uint8_t diversity_mode)
      display.print(PSTR2("A:"));
   display.setCursor(5, display.height() - 9);
   display.print(PSTR2("B"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
-void screens::updateDiversity(char active_receiver, uint8_t rssiA, uint8_t rssiB)
+void screens::updateDiversity(char active_receiver, uint8_t rssiA, uint8_t rssiB, uint8_t switchesPerMin)
 {
+#undef RSSI_BAR_SIZE
 #define RSSI_BAR_SIZE 108
+  // antenna switches in last minute (right side of title bar)
+  display.fillRect(display.width() - 44, 1, 43, 9, WHITE);
+  display.setTextColor(BLACK);
+  display.setCursor(display.width() - 44, 2);
+  display.print(switchesPerMin);
+  display.print(PSTR2("/MIN"));
+  display.setTextColor(WHITE);
+
   uint8_t rssi_scaled = map(rssiA, 1, 100, 1, RSSI_BAR_SIZE);
  
   display.fillRect(18 + rssi_scaled, display.height() - 19, (RSSI_BAR_SIZE - rssi_scaled), 7, BLACK);
@@ -751,7 +947,7 @@ void screens::updateDiversity(char active_receiver, uint8_t rssiA, uint8_t rssiB
     display.fillRect(18, display.height() - 9, rssi_scaled, 7, BLACK);
     display.drawRect(18, display.height() - 9, rssi_scaled, 7, WHITE);
   }
-  display.display();
+  displayDirtyFlag = true;
 }
 #endif
  
@@ -810,10 +1006,10 @@ void screens::updateSetupMenu(uint8_t menu_id, bool settings_beeps, bool setting
   display.setTextColor(menu_id == 4 ? BLACK : WHITE);
   display.setCursor(5, 10 * 5 + 3);
   display.print(PSTR2("SAVE & EXIT"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
-void screens::save(uint8_t mode, uint8_t channelIndex, uint16_t channelFrequency, const char *call_sign,int lfav)
+void screens::save(uint8_t /*mode*/, uint8_t channelIndex, uint16_t channelFrequency, const char * /*call_sign*/,int lfav)
 {
   reset();
   drawTitleBox(PSTR2("SAVE SETTINGS"));
@@ -893,7 +1089,7 @@ void screens::save(uint8_t mode, uint8_t channelIndex, uint16_t channelFrequency
 // 
   display.setCursor(((display.width() - 11 * 6) / 2), 8 * 6 + 4);
   display.print(PSTR2("-- SAVED --"));
-  display.display();
+  displayDirtyFlag = true;
 }
  
 void screens::updateSave(const char * msg)
@@ -901,7 +1097,7 @@ void screens::updateSave(const char * msg)
   display.setTextColor(WHITE, BLACK);
   display.setCursor(((display.width() - strlen(msg) * 6) / 2), 8 * 6 + 4);
   display.print(msg);
-  display.display();
+  displayDirtyFlag = true;
 }
  
  
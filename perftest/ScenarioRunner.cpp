@@ -0,0 +1,443 @@
+//Runs the unmodified firmware ('setup()' and 'loop()') on virtual
+// hardware, driven by a scripted timeline, records metrics in virtual
+// time and checks them against stored thresholds.
+//
+// Usage:  perftest [-v] <scenario-file> [<thresholds-file>]
+//  -v  show text sent by the firmware to the serial port
+// Exit status is 1 if a metric is past its threshold, 2 on bad input.
+//
+// Scenario lines are "<ms> <command> [args]" ('#' starts a comment):
+//  <ms> vtx <MHz> <level>       transmitter on at raw RSSI level (0 = off)
+//  <ms> press <button>          button held (UP, DOWN, MODE or SAVE)
+//  <ms> release <button>        button released
+//  <ms> click <button>          button pressed for CLICK_HOLD_MS
+//  <ms> serial <text>           text and newline received on serial port
+//  <ms> gain <A|B> <pct> [<ramp-ms>]   receiver fade (100 = full signal)
+//  <ms> end                     end of run
+//
+// Threshold lines are "<scenario> <metric> <op> <value>", where
+// <scenario> is the scenario file name without path or extension and
+// <op> is "<=" or ">=".
+
+#include <Arduino.h>
+
+#include "settings.h"
+#include "PerfStats.h"
+#include "VirtualHw.h"
+
+#ifndef USE_PERF_METRICS
+#error "perftest must be built with USE_PERF_METRICS defined"
+#endif
+
+// CPU time (us) charged for each pass through 'loop()', on top of the
+// time charged for the Arduino calls it makes
+#define LOOP_OVERHEAD_US 20
+
+#define CLICK_HOLD_MS 150
+
+// video is taken as on the weaker receiver while its gain is this many
+// percent below the other receiver's
+#define SWITCH_LAG_GAIN_PCT 5
+
+#define MAX_EVENTS 200
+#define MAX_TEXT_LEN 32
+#define MAX_LINE_LEN 128
+
+#define EVT_VTX 0
+#define EVT_PRESS 1
+#define EVT_RELEASE 2
+#define EVT_SERIAL 3
+#define EVT_GAIN 4
+
+typedef struct
+{
+  unsigned long timeMs;
+  uint8_t type;
+  uint16_t arg1;
+  uint16_t arg2;
+  unsigned long arg3;
+  char text[MAX_TEXT_LEN];
+} ScenarioEvent;
+
+#define METRIC_VTX_LOCK_MS 0
+#define METRIC_SEEK_LOCK_MS 1
+#define METRIC_SCAN_SWEEP_MS 2
+#define METRIC_RETUNES 3
+#define METRIC_DISPLAYS 4
+#define METRIC_EEPROM_WRITES 5
+#define METRIC_ANTENNA_SWITCHES 6
+#define METRIC_TUNED_MHZ 7
+#define METRIC_SWITCH_LAG_MS 8
+#define METRIC_COUNT 9
+
+static const char * const metricNames[METRIC_COUNT] = {
+  "vtx_lock_ms",          // last transmitter on to next seek lock
+  "seek_lock_ms",         // seek start to channel found (last seek)
+  "scan_sweep_ms",        // longest full band-scan sweep
+  "retunes",              // frequencies latched by the tuners
+  "displays",             // screen updates sent to display
+  "eeprom_writes",        // bytes written to EEPROM
+  "antenna_switches",     // video switched between receivers
+  "tuned_mhz",            // frequency on video at end of run
+  "switch_lag_ms"         // longest time video was on weaker receiver
+};
+
+void setup();
+void loop();
+
+static ScenarioEvent scenarioEvents[MAX_EVENTS];
+static int scenarioEventCount = 0;
+static int nextEventIdx = 0;
+static unsigned long scenarioEndMs = 0;
+
+// time last transmitter was switched on, and time from then to the
+// next seek lock (-1 if none yet)
+static bool vtxOnFlag = false;
+static unsigned long vtxOnMs = 0;
+static long vtxLockMs = -1;
+static bool seekTimerRunningFlag = false;
+
+// time video went onto the weaker receiver (0 if not on it), and
+// longest time it stayed there (-1 if never)
+static unsigned long weakRcvrStartMs = 0;
+static long switchLagMs = -1;
+
+static long metricValues[METRIC_COUNT];
+static bool metricValidFlags[METRIC_COUNT];
+
+static bool loadScenario(const char *fileName);
+static bool addEvent(unsigned long timeMs, uint8_t type, uint16_t arg1,
+                     uint16_t arg2, unsigned long arg3, const char *text);
+static int buttonNameToPin(const char *name);
+static void applyScenarioEvents(unsigned long nowMs);
+static void trackSeekLock(unsigned long nowMs);
+static void trackSwitchLag(unsigned long nowMs);
+static void recordMetrics();
+static int checkThresholds(const char *fileName, const char *scenarioName);
+static int findMetric(const char *name);
+static void getScenarioName(const char *fileName, char *nameBuf, size_t bufSize);
+
+
+int main(int argc, char **argv)
+{
+  int argIdx = 1;
+  if (argIdx < argc && strcmp(argv[argIdx], "-v") == 0)
+  {
+    setVhwSerialEcho(true);
+    ++argIdx;
+  }
+  if (argIdx >= argc)
+  {
+    fprintf(stderr, "Usage: perftest [-v] <scenario-file> [<thresholds-file>]\n");
+    return 2;
+  }
+  const char * const scenarioFile = argv[argIdx++];
+  if (!loadScenario(scenarioFile))
+    return 2;
+  char scenarioName[64];
+  getScenarioName(scenarioFile, scenarioName, sizeof(scenarioName));
+
+  setVhwTickHandler(applyScenarioEvents);
+  setup();
+  while (getVhwTimeMs() < scenarioEndMs)
+  {
+    loop();
+    advanceVhwTime(LOOP_OVERHEAD_US);
+  }
+  recordMetrics();
+
+  printf("%s:", scenarioName);
+  for (uint8_t i = 0; i < METRIC_COUNT; ++i)
+  {
+    if (metricValidFlags[i])
+      printf(" %s=%ld", metricNames[i], metricValues[i]);
+    else
+      printf(" %s=-", metricNames[i]);
+  }
+  printf("\n");
+
+  if (argIdx < argc)
+    return checkThresholds(argv[argIdx], scenarioName);
+  return 0;
+}
+
+//Reads the given scenario file into 'scenarioEvents[]'.  Returns false
+// (after showing an error) if the file is invalid.
+static bool loadScenario(const char *fileName)
+{
+  FILE *fp = fopen(fileName, "r");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "Unable to open scenario file: %s\n", fileName);
+    return false;
+  }
+  char lineBuf[MAX_LINE_LEN];
+  int lineNum = 0;
+  bool okFlag = true;
+  while (okFlag && fgets(lineBuf, sizeof(lineBuf), fp) != NULL)
+  {
+    ++lineNum;
+    char *cPtr = strchr(lineBuf, '#');
+    if (cPtr != NULL)
+      *cPtr = '\0';
+    unsigned long timeMs;
+    char cmdStr[16], argStr[MAX_TEXT_LEN];
+    int val1, val2;
+    const int numFields = sscanf(lineBuf, "%lu %15s", &timeMs, cmdStr);
+    if (numFields <= 0)
+      continue;          //blank line
+    if (numFields != 2)
+      okFlag = false;
+    else if (strcmp(cmdStr, "end") == 0)
+      scenarioEndMs = timeMs;
+    else if (strcmp(cmdStr, "vtx") == 0)
+      okFlag = (sscanf(lineBuf, "%*u %*s %d %d", &val1, &val2) == 2 &&
+                      addEvent(timeMs, EVT_VTX, val1, val2, 0, NULL));
+    else if (strcmp(cmdStr, "press") == 0 || strcmp(cmdStr, "release") == 0 ||
+                                               strcmp(cmdStr, "click") == 0)
+    {
+      okFlag = (sscanf(lineBuf, "%*u %*s %31s", argStr) == 1 &&
+                                           (val1=buttonNameToPin(argStr)) >= 0);
+      if (okFlag && cmdStr[0] != 'r')
+        okFlag = addEvent(timeMs, EVT_PRESS, val1, 0, 0, NULL);
+      if (okFlag && cmdStr[0] != 'p')
+        okFlag = addEvent((cmdStr[0] == 'c') ? timeMs + CLICK_HOLD_MS : timeMs,
+                          EVT_RELEASE, val1, 0, 0, NULL);
+    }
+    else if (strcmp(cmdStr, "serial") == 0)
+    {
+      okFlag = (sscanf(lineBuf, "%*u %*s %30s", argStr) == 1);
+      if (okFlag)
+      {
+        strcat(argStr, "\n");
+        okFlag = addEvent(timeMs, EVT_SERIAL, 0, 0, 0, argStr);
+      }
+    }
+    else if (strcmp(cmdStr, "gain") == 0)
+    {
+      unsigned long rampMs = 0;
+      okFlag = (sscanf(lineBuf, "%*u %*s %1s %d %lu", argStr, &val1,
+                                                                &rampMs) >= 2 &&
+                (argStr[0] == 'A' || argStr[0] == 'B') &&
+                addEvent(timeMs, EVT_GAIN,
+                         (argStr[0] == 'A') ? VHW_RCVR_A : VHW_RCVR_B,
+                         val1, rampMs, NULL));
+    }
+    else
+      okFlag = false;
+  }
+  fclose(fp);
+  if (okFlag && scenarioEndMs == 0)
+  {
+    fprintf(stderr, "No 'end' in scenario file: %s\n", fileName);
+    return false;
+  }
+  if (!okFlag)
+    fprintf(stderr, "Invalid line %d in scenario file: %s\n", lineNum, fileName);
+  return okFlag;
+}
+
+//Adds an event to 'scenarioEvents[]', keeping it sorted by time (events
+// at the same time stay in file order).  Returns false if full.
+static bool addEvent(unsigned long timeMs, uint8_t type, uint16_t arg1,
+                     uint16_t arg2, unsigned long arg3, const char *text)
+{
+  if (scenarioEventCount >= MAX_EVENTS)
+    return false;
+  int idx = scenarioEventCount++;
+  while (idx > 0 && scenarioEvents[idx-1].timeMs > timeMs)
+  {
+    scenarioEvents[idx] = scenarioEvents[idx-1];
+    --idx;
+  }
+  ScenarioEvent *evPtr = &scenarioEvents[idx];
+  evPtr->timeMs = timeMs;
+  evPtr->type = type;
+  evPtr->arg1 = arg1;
+  evPtr->arg2 = arg2;
+  evPtr->arg3 = arg3;
+  evPtr->text[0] = '\0';
+  if (text != NULL)
+    strncat(evPtr->text, text, MAX_TEXT_LEN - 1);
+  return true;
+}
+
+//Returns the pin for the given button name, or -1 if not a button name.
+static int buttonNameToPin(const char *name)
+{
+  if (strcmp(name, "UP") == 0)
+    return buttonUp;
+  if (strcmp(name, "DOWN") == 0)
+    return buttonDown;
+  if (strcmp(name, "MODE") == 0)
+    return buttonMode;
+  if (strcmp(name, "SAVE") == 0)
+    return buttonSave;
+  return -1;
+}
+
+//Applies scenario events that are due; called by the virtual hardware
+// every millisecond.
+static void applyScenarioEvents(unsigned long nowMs)
+{
+  while (nextEventIdx < scenarioEventCount &&
+                                 scenarioEvents[nextEventIdx].timeMs <= nowMs)
+  {
+    const ScenarioEvent *evPtr = &scenarioEvents[nextEventIdx++];
+    switch (evPtr->type)
+    {
+      case EVT_VTX:
+        setVhwTransmitter(evPtr->arg1, evPtr->arg2);
+        if (evPtr->arg2 > 0)
+        {
+          vtxOnFlag = true;
+          vtxOnMs = nowMs;
+          vtxLockMs = -1;
+        }
+        break;
+      case EVT_PRESS:
+        setVhwButton(evPtr->arg1, true);
+        break;
+      case EVT_RELEASE:
+        setVhwButton(evPtr->arg1, false);
+        break;
+      case EVT_SERIAL:
+        sendVhwSerialText(evPtr->text);
+        break;
+      case EVT_GAIN:
+        setVhwReceiverGain(evPtr->arg1, evPtr->arg2, evPtr->arg3);
+        break;
+    }
+  }
+  trackSeekLock(nowMs);
+  trackSwitchLag(nowMs);
+}
+
+//Records the time from the last transmitter switched on to the next
+// seek lock (seek-lock timer stopped).
+static void trackSeekLock(unsigned long nowMs)
+{
+  const bool runningFlag = isPerfTimerRunning(PERF_TMR_SEEK_LOCK);
+  if (seekTimerRunningFlag && !runningFlag && vtxOnFlag && vtxLockMs < 0)
+    vtxLockMs = nowMs - vtxOnMs;
+  seekTimerRunningFlag = runningFlag;
+}
+
+//Records the longest time the video stays on the weaker receiver (its
+// gain at least SWITCH_LAG_GAIN_PCT below the other receiver's) before
+// switching or the fade ending.
+static void trackSwitchLag(unsigned long nowMs)
+{
+  const uint8_t videoRcvr = getVhwVideoReceiver();
+  const bool weakFlag = (getVhwReceiverGain(videoRcvr) + SWITCH_LAG_GAIN_PCT <=
+                   getVhwReceiverGain((videoRcvr == VHW_RCVR_A) ? VHW_RCVR_B :
+                                                                  VHW_RCVR_A));
+  if (weakFlag && weakRcvrStartMs == 0)
+    weakRcvrStartMs = nowMs;
+  else if (!weakFlag && weakRcvrStartMs != 0)
+  {
+    if ((long)(nowMs - weakRcvrStartMs) > switchLagMs)
+      switchLagMs = nowMs - weakRcvrStartMs;
+    weakRcvrStartMs = 0;
+  }
+}
+
+//Fills in 'metricValues[]' at the end of a run.  Timer metrics are
+// invalid if the timer was never stopped (no lock or no full sweep).
+static void recordMetrics()
+{
+  metricValues[METRIC_VTX_LOCK_MS] = vtxLockMs;
+  metricValues[METRIC_SEEK_LOCK_MS] = getPerfTimerLastMs(PERF_TMR_SEEK_LOCK);
+  metricValues[METRIC_SCAN_SWEEP_MS] = getPerfTimerMaxMs(PERF_TMR_SCAN_SWEEP);
+  metricValues[METRIC_RETUNES] = getVhwTunerWriteCount();
+  metricValues[METRIC_DISPLAYS] = getVhwDisplayCount();
+  metricValues[METRIC_EEPROM_WRITES] = getVhwEepromWriteCount();
+  metricValues[METRIC_ANTENNA_SWITCHES] = getVhwAntennaSwitchCount();
+  metricValues[METRIC_TUNED_MHZ] = getVhwTunedFreq(getVhwVideoReceiver());
+  metricValues[METRIC_SWITCH_LAG_MS] = switchLagMs;
+  for (uint8_t i = 0; i < METRIC_COUNT; ++i)
+    metricValidFlags[i] = true;
+  metricValidFlags[METRIC_VTX_LOCK_MS] = (vtxLockMs >= 0);
+  metricValidFlags[METRIC_SEEK_LOCK_MS] = (metricValues[METRIC_SEEK_LOCK_MS] > 0);
+  metricValidFlags[METRIC_SCAN_SWEEP_MS] = (metricValues[METRIC_SCAN_SWEEP_MS] > 0);
+  metricValidFlags[METRIC_SWITCH_LAG_MS] = (switchLagMs >= 0);
+}
+
+//Checks the recorded metrics against the thresholds for the given
+// scenario in the given file.  Returns 0 if all are within limits, 1 if
+// any are not (or a metric with a threshold was not recorded), or 2 if
+// the file is invalid.
+static int checkThresholds(const char *fileName, const char *scenarioName)
+{
+  FILE *fp = fopen(fileName, "r");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "Unable to open thresholds file: %s\n", fileName);
+    return 2;
+  }
+  char lineBuf[MAX_LINE_LEN];
+  int lineNum = 0;
+  int retVal = 0;
+  while (retVal < 2 && fgets(lineBuf, sizeof(lineBuf), fp) != NULL)
+  {
+    ++lineNum;
+    char *cPtr = strchr(lineBuf, '#');
+    if (cPtr != NULL)
+      *cPtr = '\0';
+    char nameStr[64], metricStr[32], opStr[4];
+    long limitVal;
+    const int numFields = sscanf(lineBuf, "%63s %31s %3s %ld",
+                                 nameStr, metricStr, opStr, &limitVal);
+    if (numFields <= 0)
+      continue;          //blank line
+    const int metricIdx = findMetric(metricStr);
+    if (numFields != 4 || metricIdx < 0 ||
+                          (strcmp(opStr, "<=") != 0 && strcmp(opStr, ">=") != 0))
+    {
+      fprintf(stderr, "Invalid line %d in thresholds file: %s\n",
+                                                           lineNum, fileName);
+      retVal = 2;
+      break;
+    }
+    if (strcmp(nameStr, scenarioName) != 0)
+      continue;
+    if (!metricValidFlags[metricIdx])
+    {
+      printf("FAIL %s: %s not recorded\n", scenarioName, metricStr);
+      retVal = 1;
+      continue;
+    }
+    const long val = metricValues[metricIdx];
+    if ((opStr[0] == '<') ? (val > limitVal) : (val < limitVal))
+    {
+      printf("FAIL %s: %s=%ld (limit %s %ld)\n", scenarioName, metricStr,
+                                                      val, opStr, limitVal);
+      retVal = 1;
+    }
+  }
+  fclose(fp);
+  return retVal;
+}
+
+//Returns the index for the given metric name, or -1 if not found.
+static int findMetric(const char *name)
+{
+  for (uint8_t i = 0; i < METRIC_COUNT; ++i)
+  {
+    if (strcmp(name, metricNames[i]) == 0)
+      return i;
+  }
+  return -1;
+}
+
+//Copies the file name without path or extension into the given buffer.
+static void getScenarioName(const char *fileName, char *nameBuf, size_t bufSize)
+{
+  const char *cPtr = strrchr(fileName, '/');
+  if (cPtr != NULL)
+    fileName = cPtr + 1;
+  snprintf(nameBuf, bufSize, "%s", fileName);
+  char * const dotPtr = strrchr(nameBuf, '.');
+  if (dotPtr != NULL)
+    *dotPtr = '\0';
+}
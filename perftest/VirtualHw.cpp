@@ -0,0 +1,480 @@
+//Virtual hardware for running the firmware on the host:  a virtual
+// clock (each Arduino call costs about the time it takes on the AVR),
+// the RX5808 tuners (channel decoded from the bit-banged SPI frames),
+// RSSI from simulated transmitters, buttons, serial, EEPROM and a
+// display that only counts updates.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "settings.h"
+#include "Adafruit_SSD1306.h"
+#include "VirtualHw.h"
+
+// approximate AVR (16 MHz) cost of each call, in microseconds
+#define VHW_PIN_IO_US 4
+#define VHW_ANALOG_READ_US 112
+#define VHW_MILLIS_US 1
+#define VHW_EEPROM_WRITE_US 3400
+// full 128x64 screen sent over I2C at 400 kHz
+#define VHW_DISPLAY_US 25000
+
+#define VHW_PIN_COUNT 32
+
+volatile uint8_t PORTC, SREG, OCR0A, TIMSK0;
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+extern "C" void TIMER0_COMPA_vect(void);
+
+static unsigned long long vhwTimeUs = 0;
+static unsigned long long vhwNextTickUs = 1000;
+static bool vhwInTickFlag = false;
+static VhwTickHandler vhwTickHandlerFn = NULL;
+
+static uint8_t vhwPinLevels[VHW_PIN_COUNT];
+
+// tuner state (shift register fed while select line is low, latched
+// on its rising edge)
+static const uint8_t vhwSelectPins[2] = {
+  slaveSelectPin,
+#ifdef slaveSelectPinB
+  slaveSelectPinB
+#else
+  slaveSelectPin          //receivers share select line
+#endif
+};
+static uint32_t vhwShiftBits[2];
+static uint8_t vhwShiftCount[2];
+static uint16_t vhwTunedFreqs[2];
+static unsigned long vhwTunerWrites = 0;
+
+// simulated transmitters (level is raw ADC value at center frequency)
+static uint16_t vhwTxFreqs[VHW_MAX_TRANSMITTERS];
+static uint16_t vhwTxLevels[VHW_MAX_TRANSMITTERS];
+
+// receiver gain in percent, ramped linearly to target
+static uint8_t vhwGainStart[2] = { 100, 100 };
+static uint8_t vhwGainTarget[2] = { 100, 100 };
+static unsigned long vhwGainRampStartMs[2];
+static unsigned long vhwGainRampMs[2];
+
+static uint32_t vhwNoiseSeed = 1;
+
+static char vhwSerialInBuf[256];
+static uint8_t vhwSerialInHead = 0;
+static uint8_t vhwSerialInTail = 0;
+
+static uint8_t vhwEepromMem[EEPROM_SIZE];
+static bool vhwEepromInitFlag = false;
+static unsigned long vhwEepromWrites = 0;
+
+static bool vhwSerialEchoFlag = false;
+
+static unsigned long vhwDisplayCount = 0;
+
+static uint8_t vhwAntennaBits = 0;
+static unsigned long vhwAntennaSwitches = 0;
+
+static void checkAntennaSwitch();
+static void updateTunerPins(uint8_t pin, uint8_t val);
+static uint16_t getReceiverGain(uint8_t rcvrId);
+static int calcRssiRaw(uint8_t rcvrId);
+
+
+//Sets the function called each virtual millisecond.
+void setVhwTickHandler(VhwTickHandler handlerFn)
+{
+  vhwTickHandlerFn = handlerFn;
+}
+
+//Advances virtual time by the given number of microseconds, running the
+// Timer0 interrupt (buttons, beeper) and the tick handler for each
+// millisecond passed.  Time spent inside the interrupt is not counted.
+void advanceVhwTime(unsigned long us)
+{
+  if (vhwInTickFlag)
+    return;
+  const unsigned long long endUs = vhwTimeUs + us;
+  while (vhwNextTickUs <= endUs)
+  {
+    vhwTimeUs = vhwNextTickUs;
+    vhwNextTickUs += 1000;
+    vhwInTickFlag = true;
+    if (TIMSK0 & _BV(OCIE0A))
+      TIMER0_COMPA_vect();
+    checkAntennaSwitch();
+    if (vhwTickHandlerFn != NULL)
+      (*vhwTickHandlerFn)(getVhwTimeMs());
+    vhwInTickFlag = false;
+  }
+  vhwTimeUs = endUs;
+}
+
+//Returns the current virtual time in ms (without advancing it).
+unsigned long getVhwTimeMs()
+{
+  return (unsigned long)(vhwTimeUs / 1000);
+}
+
+//Sets the state of the button on the given pin.
+void setVhwButton(uint8_t pin, bool pressedFlag)
+{
+  if (pin < VHW_PIN_COUNT)    //buttons are active low (pulled up)
+    vhwPinLevels[pin] = pressedFlag ? LOW : HIGH;
+}
+
+//Adds a transmitter on the given frequency, or changes its level if
+// already present; a level of 0 removes it.  Returns false if there
+// is no room for another transmitter.
+bool setVhwTransmitter(uint16_t freqMhz, uint16_t level)
+{
+  int freeIdx = -1;
+  for (uint8_t i = 0; i < VHW_MAX_TRANSMITTERS; ++i)
+  {
+    if (vhwTxFreqs[i] == freqMhz)
+    {
+      vhwTxLevels[i] = level;
+      if (level == 0)
+        vhwTxFreqs[i] = 0;
+      return true;
+    }
+    if (vhwTxFreqs[i] == 0 && freeIdx < 0)
+      freeIdx = i;
+  }
+  if (level == 0)
+    return true;
+  if (freeIdx < 0)
+    return false;
+  vhwTxFreqs[freeIdx] = freqMhz;
+  vhwTxLevels[freeIdx] = level;
+  return true;
+}
+
+//Ramps the gain of the given receiver (percent of transmitter level
+// above the floor) to the given value over the given time, to simulate
+// an antenna fade.
+void setVhwReceiverGain(uint8_t rcvrId, uint8_t pct, unsigned long rampMs)
+{
+  vhwGainStart[rcvrId] = getReceiverGain(rcvrId);
+  vhwGainTarget[rcvrId] = pct;
+  vhwGainRampStartMs[rcvrId] = getVhwTimeMs();
+  vhwGainRampMs[rcvrId] = rampMs;
+}
+
+//Queues the given text as received on the serial port.
+void sendVhwSerialText(const char *str)
+{
+  while (*str)
+  {
+    const uint8_t nextHead = (uint8_t)(vhwSerialInHead + 1);
+    if (nextHead == vhwSerialInTail)
+      break;             //buffer full
+    vhwSerialInBuf[vhwSerialInHead] = *str++;
+    vhwSerialInHead = nextHead;
+  }
+}
+
+//Sets whether text sent by the firmware to the serial port is shown
+// on stdout.
+void setVhwSerialEcho(bool echoFlag)
+{
+  vhwSerialEchoFlag = echoFlag;
+}
+
+//Returns the frequency (MHz) the given receiver is tuned to.
+uint16_t getVhwTunedFreq(uint8_t rcvrId)
+{
+  return vhwTunedFreqs[rcvrId];
+}
+
+//Returns the current gain (percent) of the given receiver.
+uint8_t getVhwReceiverGain(uint8_t rcvrId)
+{
+  return (uint8_t)getReceiverGain(rcvrId);
+}
+
+//Returns the receiver whose video is selected.
+uint8_t getVhwVideoReceiver()
+{
+  return (vhwAntennaBits == B00000010) ? VHW_RCVR_B : VHW_RCVR_A;
+}
+
+//Returns the number of frequencies latched by the tuners (a frame
+// received by both receivers counts twice).
+unsigned long getVhwTunerWriteCount()
+{
+  return vhwTunerWrites;
+}
+
+//Returns the number of screen updates sent to the display.
+unsigned long getVhwDisplayCount()
+{
+  return vhwDisplayCount;
+}
+
+//Returns the number of bytes written to EEPROM.
+unsigned long getVhwEepromWriteCount()
+{
+  return vhwEepromWrites;
+}
+
+//Returns the number of times the video was switched between receivers.
+unsigned long getVhwAntennaSwitchCount()
+{
+  return vhwAntennaSwitches;
+}
+
+//Counts a switch if the receiver-select outputs have changed.
+static void checkAntennaSwitch()
+{
+#ifdef USE_FAST_SWITCHING
+  const uint8_t bits = PORTC & (B00000001 | B00000010);
+#else
+  const uint8_t bits = vhwPinLevels[receiverA_led] |
+#ifdef USE_DIVERSITY
+                       (vhwPinLevels[receiverB_led] << 1);
+#else
+                       0;
+#endif
+#endif
+  if (bits != vhwAntennaBits)
+  {
+    if (vhwAntennaBits != 0)      //first select at startup not counted
+      ++vhwAntennaSwitches;
+    vhwAntennaBits = bits;
+  }
+}
+
+//Feeds a pin change to the tuners:  data is shifted in (LSB first) on
+// rising clock edges while a receiver's select line is low, and a write
+// to register 1 (frequency) takes effect when the select line goes high.
+static void updateTunerPins(uint8_t pin, uint8_t val)
+{
+  if (pin == spiClockPin && val == HIGH && vhwPinLevels[pin] == LOW)
+  {
+    for (uint8_t r = 0; r < 2; ++r)
+    {
+      if (vhwPinLevels[vhwSelectPins[r]] != LOW)
+        continue;
+      if (vhwShiftCount[r] < 32 && vhwPinLevels[spiDataPin] == HIGH)
+        vhwShiftBits[r] |= (uint32_t)1 << vhwShiftCount[r];
+      ++vhwShiftCount[r];
+    }
+    return;
+  }
+  for (uint8_t r = 0; r < 2; ++r)
+  {
+    if (pin != vhwSelectPins[r] || val == vhwPinLevels[pin])
+      continue;
+    if (val == HIGH && vhwShiftCount[r] == 25 &&
+                                         (vhwShiftBits[r] & 0x1F) == 0x11)
+    {  //write to register 1; data is N (D7-D15) and A (D0-D6)
+      const uint16_t regVal = (uint16_t)(vhwShiftBits[r] >> 5);
+      vhwTunedFreqs[r] = 2 * ((regVal >> 7) * 32 + (regVal & 0x7F)) + 479;
+      ++vhwTunerWrites;
+    }
+    vhwShiftBits[r] = 0;
+    vhwShiftCount[r] = 0;
+  }
+}
+
+//Returns the current gain (percent) of the given receiver.
+static uint16_t getReceiverGain(uint8_t rcvrId)
+{
+  const unsigned long elapsedMs = getVhwTimeMs() - vhwGainRampStartMs[rcvrId];
+  if (elapsedMs >= vhwGainRampMs[rcvrId])
+    return vhwGainTarget[rcvrId];
+  return vhwGainStart[rcvrId] +
+         ((long)vhwGainTarget[rcvrId] - vhwGainStart[rcvrId]) *
+                                  (long)elapsedMs / (long)vhwGainRampMs[rcvrId];
+}
+
+//Returns the raw RSSI ADC value for the given receiver:  the strongest
+// transmitter near its tuned frequency (scaled by its gain) plus a few
+// counts of noise.
+static int calcRssiRaw(uint8_t rcvrId)
+{
+  int sigVal = 0;
+  for (uint8_t i = 0; i < VHW_MAX_TRANSMITTERS; ++i)
+  {
+    if (vhwTxFreqs[i] == 0 || vhwTxLevels[i] <= VHW_RSSI_FLOOR)
+      continue;
+    const int distMhz = abs((int)vhwTunedFreqs[rcvrId] - (int)vhwTxFreqs[i]);
+    if (distMhz >= VHW_SIGNAL_WIDTH_MHZ)
+      continue;
+    const int val = (vhwTxLevels[i] - VHW_RSSI_FLOOR) *
+                     (VHW_SIGNAL_WIDTH_MHZ - distMhz) / VHW_SIGNAL_WIDTH_MHZ;
+    if (val > sigVal)
+      sigVal = val;
+  }
+  vhwNoiseSeed = vhwNoiseSeed * 1103515245 + 12345;     //repeatable noise
+  return VHW_RSSI_FLOOR + sigVal * getReceiverGain(rcvrId) / 100 +
+                                              (int)((vhwNoiseSeed >> 16) % 5);
+}
+
+
+// Arduino core ------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < VHW_PIN_COUNT && mode == INPUT_PULLUP)
+    vhwPinLevels[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  advanceVhwTime(VHW_PIN_IO_US);
+  if (pin >= VHW_PIN_COUNT)
+    return;
+  updateTunerPins(pin, val);
+  vhwPinLevels[pin] = val;
+}
+
+int digitalRead(uint8_t pin)
+{
+  advanceVhwTime(VHW_PIN_IO_US);
+  return (pin < VHW_PIN_COUNT) ? vhwPinLevels[pin] : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+  advanceVhwTime(VHW_ANALOG_READ_US);
+  if (pin == rssiPinA)
+    return calcRssiRaw(VHW_RCVR_A);
+#ifdef USE_DIVERSITY
+  if (pin == rssiPinB)
+    return calcRssiRaw(VHW_RCVR_B);
+#endif
+  return 0;
+}
+
+void delay(unsigned long ms)
+{
+  advanceVhwTime(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  advanceVhwTime(us);
+}
+
+unsigned long millis()
+{
+  advanceVhwTime(VHW_MILLIS_US);
+  return getVhwTimeMs();
+}
+
+unsigned long micros()
+{
+  return (unsigned long)vhwTimeUs;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+char *itoa(int val, char *buf, int radix)
+{
+  sprintf(buf, (radix == 16) ? "%x" : "%d", val);
+  return buf;
+}
+
+void HardwareSerial::begin(unsigned long)
+{
+}
+
+int HardwareSerial::available()
+{
+  return (uint8_t)(vhwSerialInHead - vhwSerialInTail);
+}
+
+int HardwareSerial::read()
+{
+  if (vhwSerialInHead == vhwSerialInTail)
+    return -1;
+  return (uint8_t)vhwSerialInBuf[vhwSerialInTail++];
+}
+
+size_t HardwareSerial::write(uint8_t ch)
+{
+  if (vhwSerialEchoFlag)
+    putchar(ch);
+  return 1;
+}
+
+//EEPROM starts out erased (all 0xFF), as on a new module.
+uint8_t EEPROMClass::read(int addr)
+{
+  if (!vhwEepromInitFlag)
+  {
+    memset(vhwEepromMem, 0xFF, sizeof(vhwEepromMem));
+    vhwEepromInitFlag = true;
+  }
+  return vhwEepromMem[addr % EEPROM_SIZE];
+}
+
+void EEPROMClass::write(int addr, uint8_t val)
+{
+  read(addr);
+  vhwEepromMem[addr % EEPROM_SIZE] = val;
+  ++vhwEepromWrites;
+  advanceVhwTime(VHW_EEPROM_WRITE_US);
+}
+
+void EEPROMClass::update(int addr, uint8_t val)
+{
+  if (read(addr) != val)
+    write(addr, val);
+}
+
+
+// display (contents are not kept) -----------------------------------------
+
+Adafruit_SSD1306::Adafruit_SSD1306(int8_t) :
+                                    Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT)
+{
+}
+
+void Adafruit_SSD1306::begin(uint8_t, uint8_t, bool)
+{
+}
+
+void Adafruit_SSD1306::clearDisplay(void)
+{
+}
+
+void Adafruit_SSD1306::invertDisplay(uint8_t)
+{
+}
+
+void Adafruit_SSD1306::dim(boolean)
+{
+}
+
+void Adafruit_SSD1306::display(void)
+{
+  ++vhwDisplayCount;
+  advanceVhwTime(VHW_DISPLAY_US);
+}
+
+void Adafruit_SSD1306::startscrollright(uint8_t, uint8_t)
+{
+}
+
+void Adafruit_SSD1306::stopscroll(void)
+{
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t, int16_t, uint16_t)
+{
+}
+
+void Adafruit_SSD1306::drawFastVLine(int16_t, int16_t, int16_t, uint16_t)
+{
+}
+
+void Adafruit_SSD1306::drawFastHLine(int16_t, int16_t, int16_t, uint16_t)
+{
+}
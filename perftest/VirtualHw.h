@@ -0,0 +1,42 @@
+// VirtualHw.h
+
+#ifndef VIRTUALHW_H_
+#define VIRTUALHW_H_
+
+#include <stdint.h>
+
+// max number of simulated transmitters
+#define VHW_MAX_TRANSMITTERS 8
+
+// raw ADC value of RSSI with no signal (RSSI_MIN_VAL is 90)
+#define VHW_RSSI_FLOOR 95
+// a transmitter is seen up to this many MHz from its frequency (its
+// RSSI falls off linearly with distance)
+#define VHW_SIGNAL_WIDTH_MHZ 40
+
+// receiver ids for 'setVhwReceiverGain()' and 'getVhwTunedFreq()'
+#define VHW_RCVR_A 0
+#define VHW_RCVR_B 1
+
+// called (outside any firmware call) each time virtual time passes a
+// millisecond, so scenario events can be applied
+typedef void (*VhwTickHandler)(unsigned long nowMs);
+
+void setVhwTickHandler(VhwTickHandler handlerFn);
+void advanceVhwTime(unsigned long us);
+unsigned long getVhwTimeMs();
+void setVhwButton(uint8_t pin, bool pressedFlag);
+bool setVhwTransmitter(uint16_t freqMhz, uint16_t level);
+void setVhwReceiverGain(uint8_t rcvrId, uint8_t pct, unsigned long rampMs);
+void sendVhwSerialText(const char *str);
+void setVhwSerialEcho(bool echoFlag);
+uint16_t getVhwTunedFreq(uint8_t rcvrId);
+uint8_t getVhwReceiverGain(uint8_t rcvrId);
+uint8_t getVhwVideoReceiver();
+unsigned long getVhwTunerWriteCount();
+unsigned long getVhwDisplayCount();
+unsigned long getVhwEepromWriteCount();
+unsigned long getVhwAntennaSwitchCount();
+
+
+#endif /* VIRTUALHW_H_ */
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Builds the firmware for the host (with the stubs in 'perftest/stubs'
+# and the virtual hardware in 'VirtualHw.cpp') and runs each scenario,
+# checking its metrics against 'thresholds.txt'.
+#
+# Usage:  perftest/run.sh [scenario-name ...]
+# (default is every file in 'perftest/scenarios')
+#
+# Set CXX to choose the host compiler, CXXFLAGS for extra options (for
+# example "-DslaveSelectPinB=8 -DUSE_SPOTTER") and BUILD_DIR for the
+# output directory.  Exit status is nonzero if any metric is past its threshold.
+
+set -e
+
+TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+SRC_DIR=$(dirname "$TEST_DIR")
+BUILD_DIR=${BUILD_DIR:-${TMPDIR:-/tmp}/rx5808_perftest}
+CXX=${CXX:-g++}
+
+mkdir -p "$BUILD_DIR"
+
+# firmware sources (not the bundled Adafruit libraries; the display
+# driver is stubbed) and the test harness are built with warnings as
+# errors; the graphics library only without the warnings it gives on a
+# 64-bit host
+FW_SRCS=$(ls "$SRC_DIR"/*.cpp | grep -v '/Adafruit_')
+LIB_SRCS="$SRC_DIR/Adafruit_GFX.cpp"
+BUILD_FLAGS="-std=gnu++11 -O1 -Wall -Wextra -DARDUINO=100 -DUSE_PERF_METRICS \
+    -I$TEST_DIR/stubs -I$TEST_DIR -I$SRC_DIR $CXXFLAGS"
+
+rm -f "$BUILD_DIR"/*.o
+(cd "$BUILD_DIR" &&
+  $CXX $BUILD_FLAGS -Werror -c $FW_SRCS \
+      "$TEST_DIR/VirtualHw.cpp" "$TEST_DIR/ScenarioRunner.cpp" &&
+  $CXX $BUILD_FLAGS -Wno-unused-parameter -Wno-unused-variable \
+      -Wno-maybe-uninitialized -Wno-int-to-pointer-cast -c $LIB_SRCS &&
+  $CXX -o perftest *.o)
+
+if [ $# -eq 0 ]; then
+  set -- $(cd "$TEST_DIR/scenarios" && ls *.txt | sed 's/\.txt$//')
+fi
+
+status=0
+for name in "$@"; do
+  "$BUILD_DIR/perftest" "$TEST_DIR/scenarios/$name.txt" \
+      "$TEST_DIR/thresholds.txt" || status=1
+done
+exit $status
@@ -0,0 +1,79 @@
+// Arduino.h (host stub for 'perftest')
+
+#ifndef PERFTEST_ARDUINO_H_
+#define PERFTEST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "Print.h"
+
+#ifndef ARDUINO
+#define ARDUINO 100
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// analog pins as numbered on the Nano
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define B00000001 0x01
+#define B00000010 0x02
+#define B11111101 0xFD
+#define B11111110 0xFE
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define _BV(b) (1 << (b))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define noInterrupts() cli()
+#define interrupts() sei()
+#define F(s) ((const __FlashStringHelper *)(s))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+char *itoa(int val, char *buf, int radix);
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  size_t write(uint8_t ch);
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+
+#endif /* PERFTEST_ARDUINO_H_ */
@@ -0,0 +1,21 @@
+// EEPROM.h (host stub for 'perftest')
+
+#ifndef PERFTEST_EEPROM_H_
+#define PERFTEST_EEPROM_H_
+
+#include <stdint.h>
+
+#define EEPROM_SIZE 1024
+
+class EEPROMClass
+{
+public:
+  uint8_t read(int addr);
+  void write(int addr, uint8_t val);
+  void update(int addr, uint8_t val);
+};
+
+extern EEPROMClass EEPROM;
+
+
+#endif /* PERFTEST_EEPROM_H_ */
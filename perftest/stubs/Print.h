@@ -0,0 +1,56 @@
+// Print.h (host stub for 'perftest')
+
+#ifndef PERFTEST_PRINT_H_
+#define PERFTEST_PRINT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+
+class Print
+{
+public:
+  virtual size_t write(uint8_t ch) = 0;
+  size_t write(const char *str)
+  {
+    size_t n = 0;
+    while (*str)
+      n += write((uint8_t)*str++);
+    return n;
+  }
+
+  size_t print(const char *str) { return write(str); }
+  size_t print(const __FlashStringHelper *str)
+                                { return write((const char *)str); }
+  size_t print(char ch) { return write((uint8_t)ch); }
+  size_t print(long val, int base = DEC)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), (base == HEX) ? "%lX" : "%ld", val);
+    return write(buf);
+  }
+  size_t print(unsigned long val, int base = DEC)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), (base == HEX) ? "%lX" : "%lu", val);
+    return write(buf);
+  }
+  size_t print(int val, int base = DEC) { return print((long)val, base); }
+  size_t print(unsigned int val, int base = DEC)
+                                { return print((unsigned long)val, base); }
+  size_t print(unsigned char val, int base = DEC)
+                                { return print((unsigned long)val, base); }
+
+  size_t println() { return write((uint8_t)'\n'); }
+  template<class T> size_t println(T val) { return print(val) + println(); }
+  template<class T> size_t println(T val, int base)
+                                { return print(val, base) + println(); }
+};
+
+
+#endif /* PERFTEST_PRINT_H_ */
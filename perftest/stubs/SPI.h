@@ -0,0 +1 @@
+// SPI.h (host stub for 'perftest'; tuner SPI is bit-banged via digitalWrite)
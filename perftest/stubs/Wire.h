@@ -0,0 +1 @@
+// Wire.h (host stub for 'perftest'; display is stubbed in 'VirtualHw.cpp')
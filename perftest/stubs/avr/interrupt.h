@@ -0,0 +1,12 @@
+// avr/interrupt.h (host stub for 'perftest')
+
+#ifndef PERFTEST_AVR_INTERRUPT_H_
+#define PERFTEST_AVR_INTERRUPT_H_
+
+// interrupt handlers are called by the virtual timer in 'VirtualHw.cpp'
+#define ISR(vect) extern "C" void vect(void); void vect(void)
+#define cli() ((void)0)
+#define sei() ((void)0)
+
+
+#endif /* PERFTEST_AVR_INTERRUPT_H_ */
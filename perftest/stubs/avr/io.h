@@ -0,0 +1,13 @@
+// avr/io.h (host stub for 'perftest')
+
+#ifndef PERFTEST_AVR_IO_H_
+#define PERFTEST_AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t PORTC, SREG, OCR0A, TIMSK0;
+
+#define OCIE0A 1
+
+
+#endif /* PERFTEST_AVR_IO_H_ */
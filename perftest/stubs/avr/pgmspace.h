@@ -0,0 +1,22 @@
+// avr/pgmspace.h (host stub for 'perftest'; flash data is ordinary memory)
+
+#ifndef PERFTEST_AVR_PGMSPACE_H_
+#define PERFTEST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_word_near(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr_near(p) (*(void * const *)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+
+#endif /* PERFTEST_AVR_PGMSPACE_H_ */
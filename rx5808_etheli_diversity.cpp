@@ -47,6 +47,19 @@
 
 #include "settings.h"
 #include "Rx5808Fns.h"
+#include "SerialCmds.h"
+#include "Buttons.h"
+#include "Beeper.h"
+#include "Tasks.h"
+#include "PerfStats.h"
+#include "RssiCal.h"
+#include "DivLog.h"
+#include "Spotter.h"
+#include "PreTune.h"
+#include "ScanResults.h"
+#include "RacePlan.h"
+#include "AutoTune.h"
+#include "WatchList.h"
 
 
 // uncomment depending on the display you are using.
@@ -85,6 +98,15 @@ screens drawScreen;
 #define EEPROM_ADRW_FREQMHZ 16         // current freq in MHz, or 0 if chanIdx instead
 #define EEPROM_ADRW_CHECKWORD 18       // integrity-check value for EEPROM
 #define EEPROM_ADR_CALLSIGN 20
+#ifdef USE_DIVERSITY
+#define EEPROM_ADRA_RSSI_MATCH 30      // receiver B-to-A offsets (RSSI_MATCH_BANDS bytes)
+#endif
+#define EEPROM_ADRA_OCCUPANCY 34       // occupied-channel bits (OCCUPANCY_BITS_SIZE bytes)
+#define EEPROM_ADRW_WATCHMASK 40       // favorites in watch list (bit 0 = slot 1)
+#define EEPROM_ADRW_RSSI_FLOOR_A 42    // RSSI noise floor (raw), or 0xFFFF if not measured
+#ifdef USE_DIVERSITY
+#define EEPROM_ADRW_RSSI_FLOOR_B 44
+#endif
 #define EEPROM_ADR_LAST_FAVIDX 60      // index of last favorite used
 
 // address for favs list in EEPROM (array of 2-byte words)
@@ -100,11 +122,18 @@ screens drawScreen;
                     ((val) >= MIN_CHANNEL_MHZ && (val) <= MAX_CHANNEL_MHZ)))
 
 
-#ifdef USE_GC9N_OSD
-#define MAX_MENU_COUNT 8
-#else    // if OSD disabled then no OSD:ON/OFF menu item
-#define MAX_MENU_COUNT 7
-#endif
+#define MAX_MENU_COUNT 9               // (OSD:ON/OFF item skipped if OSD disabled)
+
+#define MENU_TIMEOUT_MS 5000           // menus exit if no key for this long
+#define DISPLAY_REFRESH_MS 40          // min time between display transfers
+#define RSSI_SAMPLE_MS 10              // RSSI (and diversity) sample period
+#define CHANNEL_SAVE_DELAY_MS 1000     // delay before changed channel saved
+#define OCCUPANCY_SAVE_MIN_MS 60000    // min time between occupancy saves
+
+// mode-select menu phases
+#define MAIN_MENU_INACTIVE 0
+#define MAIN_MENU_RELEASE_WAIT 1       // waiting for mode-button release
+#define MAIN_MENU_ACTIVE 2
 
 void setup();
 void loop();
@@ -112,7 +141,7 @@ void setTunerToCurrentChannel();
 uint16_t channelIndexToName(uint8_t idx);
 uint16_t getCurrentChannelInMhz();
 void saveChannelToEEPROM();
-void beep(uint16_t time);
+void beep(uint16_t time, uint16_t pauseMs = 0, uint8_t count = 1);
 void initializeFavorites();
 bool addFreqOrIdxToFavs(uint16_t fVal);
 boolean deleteCurrentFavEntry();
@@ -122,7 +151,46 @@ int getFavIndexForFreqOrIdx(uint16_t fVal);
 #ifdef USE_GC9N_OSD
 void SendToOSD();
 #endif
-int8_t fsButtonDirection();
+uint8_t fetchButtonEvent();
+void inputTask();
+void uiTask();
+void tuneTask();
+void rssiTask();
+#ifdef USE_SPOTTER
+void spotterTask();
+#endif
+#ifdef USE_PRETUNE
+void preTuneTask();
+int getPreTuneChannelIdx();
+#endif
+void displayTask();
+#ifdef USE_GC9N_OSD
+void osdTask();
+void requestOsdUpdate();
+#endif
+void eepromTask();
+void enterMainMenu();
+void exitMainMenu();
+void updateMainMenu();
+void showMainMenuItem();
+void holdScreen(uint16_t timeMs);
+void showRacePlan();
+void updateMhzSeek();
+void updateAutoTune();
+void cancelAutoTune();
+void setCurrentChannelMhz(uint16_t freqVal);
+char nextWarmSeekChannel();
+void saveOccupancyToEeprom();
+void handleSerialCommands();
+void setCurrentChannelFromFavEntry(int fVal);
+void setChannelVarsFromFavEntry(int fVal);
+void showFavSweepRanking();
+int nextWatchIndex(int favIdx);
+void showWatchList();
+void startChannelSweep();
+void endChannelSweep();
+void updateRssiCalCurves();
+void writeByteToEeprom(int addr, uint8_t val);
 void writeWordToEeprom(int addr, uint16_t val);
 uint16_t readWordFromEeprom(int addr);
 
@@ -159,13 +227,17 @@ uint8_t active_receiver = useReceiverA;
 
 uint16_t rssi_min_a = RSSI_MIN_VAL;
 uint16_t rssi_max_a = RSSI_MAX_VAL;
+static uint16_t rssi_floor_a = 0;             // 0 if not measured
 uint16_t rssi_setup_min_a = RSSI_MIN_VAL;
 uint16_t rssi_setup_max_a = RSSI_MAX_VAL;
+static uint16_t rssi_setup_floor_a = 0;
 #ifdef USE_DIVERSITY
 uint16_t rssi_min_b = RSSI_MIN_VAL;
 uint16_t rssi_max_b = RSSI_MAX_VAL;
+static uint16_t rssi_floor_b = 0;
 uint16_t rssi_setup_min_b = RSSI_MIN_VAL;
 uint16_t rssi_setup_max_b = RSSI_MAX_VAL;
+static uint16_t rssi_setup_floor_b = 0;
 #endif
 
 static uint8_t rssi_setup_run = 0;
@@ -175,7 +247,6 @@ static uint8_t current_channel_index = 0;
 static uint8_t tracking_channel_index = 0;
 static uint16_t current_channel_mhz = 0;
 static char channel_sort_idx = 0;
-static uint8_t switch_count = 0;
 static uint8_t last_channel_index = 0xFF;
 static uint16_t last_channel_mhz = 0;
 static uint8_t force_seek = 0;
@@ -183,28 +254,134 @@ static bool seek_forward_flag = true;
 static unsigned long time_screen_saver = 0;
 static uint8_t seek_found = 0;
 static uint8_t last_seek_rssi = 0;
+static uint8_t seek_warm_bits[OCCUPANCY_BITS_SIZE];  // channels occupied
+                                            //  last session, tried first
+static bool occupancy_save_flag = false;    // occupancy bits may be stale
 static uint8_t scan_start = 0;
+static bool race_plan_flag = false;         // race-channel plan in progress
+static bool scan_down_flag = false;         // sweeping down in frequency
+static uint8_t scan_revisit_count = 0;      // channels since last revisit
+static int scan_revisit_idx = -1;           // channel being measured again
+                                            //  (-1 = none)
 static bool updateSeekScreenFlag = false;
-static uint8_t play_startup_beeps = 1;
+static char seek_check_sort_idx = 0;        // best channel while checking
+static uint8_t seek_check_rssi = 0;         //  neighbors of 'found' channel
+static bool seek_check_flag = false;
+static bool auto_tune_request_flag = false; // start auto fine-tune
+static bool auto_tune_active_flag = false;  // auto fine-tune running
+static uint16_t auto_tune_start_mhz = 0;    // freq before fine-tune (0 =
+                                            //  no result to show)
+static bool mhz_seek_request_flag = false;  // start seek by MHz
+static bool mhz_seek_active_flag = false;   // seek by MHz running
+static uint16_t mhz_seek_start_mhz = 0;     // freq when seek by MHz started
+static uint8_t mhz_seek_step_count = 0;     // steps done by seek by MHz
+static uint8_t mhz_seek_last_rssi = 0;      // RSSI at previous step
+static uint8_t current_rssi = 0;            // latest RSSI sample
+#ifdef slaveSelectPinB
+static bool dual_scan_flag = false;         // both receivers used in scan
+static uint8_t scan_channel_index_b = 0xFF; // receiver B channel while
+static uint8_t last_channel_index_b = 0xFF; //  scanning (0xFF = same as A)
+static uint8_t current_rssi_b = 0;          // latest RSSI of receiver B
+static int scan_revisit_idx_b = -1;         // channel measured again by B
+#endif
+#ifdef USE_PRETUNE
+static bool pretune_up_flag = true;         // direction of last manual
+static unsigned long pretune_step_time = 0; //  channel change, and time
+                                            //  (0 = none yet)
+#endif
+static bool rssi_fresh_flag = false;        // RSSI sampled since last read
+static bool rssi_pending_flag = false;      // retuned; RSSI not yet sampled
+static unsigned long rssi_sample_time = 0;
+static unsigned long screen_hold_start = 0; // screen shown for a time
+static uint16_t screen_hold_ms = 0;         //  before UI continues
+static bool screen_saver_shown_flag = false;
+static uint8_t main_menu_phase = MAIN_MENU_INACTIVE;
+static char main_menu_id = 0;
+static char main_menu_tracked_id = 0;
+static unsigned long main_menu_time = 0;
+static char setup_menu_id = 0;
+static char setup_menu_editing = -1;
+static unsigned long setup_menu_time = 0;
 
 static char call_sign[CALL_SIGN_SIZE];
 static bool settings_beeps = true;
 #ifdef USE_GC9N_OSD
 static bool settings_OSD = false;
+static bool osdUpdateFlag = false;
 #endif
 static bool settings_orderby_channel = true;
 static bool favModeInProgressFlag = false;
 //static bool FATSHARK_BUTTON_PUSHED=false;
 //static int  LAST_FATSHARK_BUTTON_STATE=0;
-static byte FS_BUTTON_DIR = 0;
+static uint8_t button_event = BTN_EV_NONE;   // current button event
 
 static uint8_t currentFavoritesCount = 0;
 static uint8_t currentFavoritesIndex = 0;
+static bool sweep_restore_flag = false;     // channel to be set again
+static uint8_t sweep_restore_idx = 0;       //  after favorites sweep or
+static uint16_t sweep_restore_mhz = 0;      //  watch list
+static bool fav_sweep_done_flag = false;    // first sweep done (ranked)
+static uint8_t fav_sweep_idx = 0;           // favorite being measured
+static uint8_t fav_sweep_sel = 0;           // ranking position selected
+static uint8_t fav_sweep_rssi[FAV_NUMBER_OF_SLOTS];  // RSSI per favorite
+static uint8_t fav_sweep_rank[FAV_NUMBER_OF_SLOTS];  // favorites by RSSI
+static uint16_t watch_mask = 0xFFFF;        // favorites in watch list
+static int watch_idx = -1;                  // favorite being watched
+static uint8_t watch_sel = 0;               // favorite at cursor
+static bool watch_sampled_flag = false;     // RSSI taken in this slot
+static bool watch_redraw_flag = false;      // new values to show
+static unsigned long watch_slot_time = 0;   // time current slot started
 static bool chanChangedSaveFlag = false;
-static bool previousUpDnButtonFlag = false;
 static bool fromScreenSaverFlag = false;
 
 
+// task names and table for scheduler
+const char inputTaskName[] PROGMEM = "input";
+const char uiTaskName[] PROGMEM = "ui";
+const char tuneTaskName[] PROGMEM = "tune";
+const char rssiTaskName[] PROGMEM = "rssi";
+#ifdef USE_SPOTTER
+const char spotterTaskName[] PROGMEM = "spotter";
+#endif
+#ifdef USE_PRETUNE
+const char preTuneTaskName[] PROGMEM = "pretune";
+#endif
+const char displayTaskName[] PROGMEM = "display";
+#ifdef USE_GC9N_OSD
+const char osdTaskName[] PROGMEM = "osd";
+#endif
+const char eepromTaskName[] PROGMEM = "eeprom";
+
+const TaskDef taskTable[] PROGMEM = {
+  { inputTask, 0, inputTaskName },
+  { uiTask, 0, uiTaskName },
+  { tuneTask, 0, tuneTaskName },
+  { rssiTask, 0, rssiTaskName },                 // sample rate is internal
+#ifdef USE_SPOTTER
+  { spotterTask, 0, spotterTaskName },           // timing is internal
+#endif
+#ifdef USE_PRETUNE
+  { preTuneTask, 0, preTuneTaskName },           // timing is internal
+#endif
+  { displayTask, DISPLAY_REFRESH_MS, displayTaskName },
+#ifdef USE_GC9N_OSD
+  { osdTask, 100, osdTaskName },
+#endif
+  { eepromTask, 100, eepromTaskName }
+};
+static_assert(sizeof(taskTable) / sizeof(taskTable[0]) <= MAX_TASK_COUNT,
+              "taskTable has more entries than MAX_TASK_COUNT (Tasks.h)");
+
+
+// Timer0 compare-match interrupt; Timer0 also drives 'millis()', so this
+// fires about once per millisecond
+ISR(TIMER0_COMPA_vect)
+{
+  buttonsTimerTick();
+  beeperTimerTick();
+}
+
+
 // SETUP ----------------------------------------------------------------------------
 void setup()
 {
@@ -216,16 +393,8 @@ void setup()
   // buzzer
   pinMode(buzzer, OUTPUT); // Feedback buzzer (active buzzer, not passive piezo)
   digitalWrite(buzzer, HIGH);
-  // minimum control pins
-  pinMode(buttonUp, INPUT);
-  digitalWrite(buttonUp, INPUT_PULLUP);
-  pinMode(buttonMode, INPUT);
-  digitalWrite(buttonMode, INPUT_PULLUP);
-  // optional control
-  pinMode(buttonDown, INPUT);
-  digitalWrite(buttonDown, INPUT_PULLUP);
-  pinMode(buttonSave, INPUT);
-  digitalWrite(buttonSave, INPUT_PULLUP);
+  // control buttons (sampled via timer interrupt)
+  initButtons();
   //Receiver Setup
   pinMode(receiverA_led, OUTPUT);
 #ifdef USE_DIVERSITY
@@ -234,6 +403,9 @@ void setup()
   setReceiver(useReceiverA);
   // SPI pins for RX control
   pinMode (slaveSelectPin, OUTPUT);
+#ifdef slaveSelectPinB
+  pinMode (slaveSelectPinB, OUTPUT);
+#endif
   pinMode (spiDataPin, OUTPUT);
   pinMode (spiClockPin, OUTPUT);
 
@@ -242,19 +414,19 @@ void setup()
   {
 
     for (int i=0; i<=255; ++i)
-      EEPROM.write(i, (uint8_t)255);
+      writeByteToEeprom(i, (uint8_t)255);
 
-    EEPROM.write(EEPROM_ADR_STATE, START_STATE);
-    EEPROM.write(EEPROM_ADR_CHANIDX, CHANNEL_MIN_INDEX);
+    writeByteToEeprom(EEPROM_ADR_STATE, START_STATE);
+    writeByteToEeprom(EEPROM_ADR_CHANIDX, CHANNEL_MIN_INDEX);
     writeWordToEeprom(EEPROM_ADRW_FREQMHZ, 0);
-    EEPROM.write(EEPROM_ADR_BEEP, settings_beeps);
-    EEPROM.write(EEPROM_ADR_LAST_FAVIDX, 0);
+    writeByteToEeprom(EEPROM_ADR_BEEP, settings_beeps);
+    writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, 0);
 #ifdef USE_GC9N_OSD
-    EEPROM.write(EEPROM_ADR_OSD, settings_OSD);
+    writeByteToEeprom(EEPROM_ADR_OSD, settings_OSD);
 #else
-    EEPROM.write(EEPROM_ADR_OSD, false);
+    writeByteToEeprom(EEPROM_ADR_OSD, false);
 #endif
-    EEPROM.write(EEPROM_ADR_ORDERBY, settings_orderby_channel);
+    writeByteToEeprom(EEPROM_ADR_ORDERBY, settings_orderby_channel);
     // save 16 bit
     writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_A, RSSI_MIN_VAL);
     // save 16 bit
@@ -264,17 +436,22 @@ void setup()
     strncpy(call_sign, CALL_SIGN, CALL_SIGN_SIZE); // load callsign
     for (uint8_t i = 0; i < sizeof(call_sign); i++)
     {
-      EEPROM.write(EEPROM_ADR_CALLSIGN + i, call_sign[i]);
+      writeByteToEeprom(EEPROM_ADR_CALLSIGN + i, call_sign[i]);
     }
 
 #ifdef USE_DIVERSITY
     // diversity
-    EEPROM.write(EEPROM_ADR_DIVERSITY, diversity_mode);
+    writeByteToEeprom(EEPROM_ADR_DIVERSITY, diversity_mode);
     // save 16 bit
     writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_B, RSSI_MIN_VAL);
     // save 16 bit
     writeWordToEeprom(EEPROM_ADRW_RSSI_MAX_B, RSSI_MAX_VAL);
+    for (uint8_t i = 0; i < RSSI_MATCH_BANDS; ++i)
+      writeByteToEeprom(EEPROM_ADRA_RSSI_MATCH + i, 0);
 #endif
+    for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+      writeByteToEeprom(EEPROM_ADRA_OCCUPANCY + i, 0);
+    writeWordToEeprom(EEPROM_ADRW_WATCHMASK, 0xFFFF);   // watch all
 
     // write EEPROM-integrity check value
     writeWordToEeprom(EEPROM_ADRW_CHECKWORD, EEPROM_CHECK_VALUE);
@@ -287,7 +464,7 @@ void setup()
   if (current_channel_index > CHANNEL_MAX_INDEX)
   {
     current_channel_index = 0;
-    EEPROM.write(EEPROM_ADR_CHANIDX, 0);
+    writeByteToEeprom(EEPROM_ADR_CHANIDX, 0);
   }
   channel_sort_idx = getChannelSortTableIndex(current_channel_index);
   tracking_channel_index = current_channel_index;
@@ -302,8 +479,28 @@ void setup()
   // set the channel as soon as we can for faster boot up times
   setTunerToCurrentChannel();
 
+  // if starting in seek mode then try channels occupied last session
+  //  after the saved channel (unused EEPROM holds all 1s)
+  if (system_state == STATE_SEEK)
+  {
+    uint8_t chkVal = 0xFF;
+    for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+    {
+      seek_warm_bits[i] = EEPROM.read(EEPROM_ADRA_OCCUPANCY + i);
+      chkVal &= seek_warm_bits[i];
+    }
+    if (chkVal == 0xFF)
+    {
+      for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+        seek_warm_bits[i] = 0;
+    }
+    seek_warm_bits[current_channel_index / 8] &=
+                               ~((uint8_t)1 << (current_channel_index % 8));
+  }
+
   // initialize 'favorites' variables
   initializeFavorites();
+  watch_mask = readWordFromEeprom(EEPROM_ADRW_WATCHMASK);
 
   settings_beeps = EEPROM.read(EEPROM_ADR_BEEP);
 #ifdef USE_GC9N_OSD
@@ -320,11 +517,19 @@ void setup()
 
   rssi_min_a = readWordFromEeprom(EEPROM_ADRW_RSSI_MIN_A);
   rssi_max_a = readWordFromEeprom(EEPROM_ADRW_RSSI_MAX_A);
+  rssi_floor_a = readWordFromEeprom(EEPROM_ADRW_RSSI_FLOOR_A);
 #ifdef USE_DIVERSITY
   diversity_mode = EEPROM.read(EEPROM_ADR_DIVERSITY);
   rssi_min_b = readWordFromEeprom(EEPROM_ADRW_RSSI_MIN_B);
   rssi_max_b = readWordFromEeprom(EEPROM_ADRW_RSSI_MAX_B);
+  rssi_floor_b = readWordFromEeprom(EEPROM_ADRW_RSSI_FLOOR_B);
+  for (uint8_t i = 0; i < RSSI_MATCH_BANDS; ++i)
+  {  //(unwritten 0xFF from older firmware taken as 0)
+    const uint8_t bVal = EEPROM.read(EEPROM_ADRA_RSSI_MATCH + i);
+    setRssiMatchOffset(i, (bVal != 0xFF) ? (int8_t)bVal : 0);
+  }
 #endif
+  updateRssiCalCurves();
   force_menu_redraw = 1;
 
   // Init Display
@@ -348,6 +553,12 @@ void setup()
   // Setup Done - Turn Status LED off.
   digitalWrite(led, LOW);
 
+  // play 3 beeps to give feedback of correct start
+#define UP_BEEP 50
+  beep(UP_BEEP, UP_BEEP, 3);
+
+  initTasks(taskTable, sizeof(taskTable) / sizeof(taskTable[0]));
+
   // initially select menu item for last-used mode
   if (system_state == STATE_FREQ_BYMHZ)
     last_state_menu_id = 3;
@@ -361,271 +572,74 @@ void setup()
 
 void loop()
 {
-  /*******************/
-  /*   Mode Select   */
-  /*******************/
-  uint8_t in_menu;
-  uint8_t in_menu_time_out;
-  if (digitalRead(buttonMode) == LOW) // key pressed ?
-  {
-    //Serial.println("kei");
+  runTasks();
+}
 
-    time_screen_saver = 0;
-    beep(50); // beep & debounce
-    delay(KEY_DEBOUNCE / 2); // debounce
-    beep(50); // beep & debounce
-    delay(KEY_DEBOUNCE / 2); // debounce
 
-    uint8_t press_time = 0;
-    // on entry wait for release
-    while (digitalRead(buttonMode) == LOW && press_time < 10)
-    {
-      delay(100);
-      press_time++;
-    }
+/*###########################################################################*/
+/*******************/
+/*      TASKS      */
+/*******************/
 
-#ifdef USE_GC9N_OSD
-    OSDParams[0] = 0; //this is main menu
-    OSDParams[1] = 3; //By default goes over manual
-    SendToOSD(); //UPDATE OSD
-#endif
+//Handles serial input (typed commands).
+void inputTask()
+{
+  handleSerialCommands();
+}
 
-    char menu_id = last_state_menu_id;
-    // Show Mode Screen
-    if (system_state == STATE_SEEK_FOUND)
-    {
-      system_state = STATE_SEEK;
-    }
+//Runs one step of the user interface: handles button events, draws the
+// screens and advances the seek and scan modes.  Never waits for a key.
+void uiTask()
+{
+  // advance race-channel plan search a step at a time; show when done
+  if (race_plan_flag && updateRacePlan())
+  {
+    race_plan_flag = false;
+    showRacePlan();
+  }
 
-    // reset flag so favorites mode will "restart"
-    favModeInProgressFlag = false;
-
-    in_menu = 0;
-    in_menu_time_out = 50; // 20x 100ms = 5 seconds
-    /*
-      Enter Mode menu
-      Show current mode
-      Change mode by MODE key
-      Any Mode will refresh screen
-      If not MODE changes in 2 seconds, it uses last used mode
-    */
-    char tracked_menu_id;
-    do
+  // keep current screen showing until hold time elapsed (or key pressed)
+  if (screen_hold_ms > 0)
+  {
+    if (millis() - screen_hold_start < screen_hold_ms &&
+        fetchButtonEvent() == BTN_EV_NONE)
     {
-      // init tracker for item to be selected when menu resumed later on
-      tracked_menu_id = last_state_menu_id;
-
-      if (press_time >= 10) // if menu held for 1 second invoke quick save.
-      {
-        // user held the mode button and wants to quick save.
-        in_menu = 0; // EXIT
-        system_state = STATE_SAVE;
-#ifdef USE_GC9N_OSD
-        OSDParams[0] = -2; //this is save
-        SendToOSD(); //UPDATE OSD
-#endif
-        break;
-      }
-
-      if (chanChangedSaveFlag)
-      {  //need to save new channel
-        chanChangedSaveFlag = false;
-        saveChannelToEEPROM();
-      }
-
-      if (!in_menu)
-      {  //first time through in-menu loop
-              //if press while manual-mode showing then jump to screen saver:
-        if (system_state == STATE_MANUAL && !fromScreenSaverFlag)
-        {
-          system_state = STATE_SCREEN_SAVER;
-          fromScreenSaverFlag = true;
-          break;
-        }
-        in_menu = 1;    //set flag to continue in-menu loop
-      }
-
-      switch (menu_id)
-      {
-        case 0: // AUTO MODE
-          system_state = STATE_SEEK;
-          tracked_menu_id = menu_id;
-          break;
-        case 1: // Band Scanner
-          system_state = STATE_SCAN;
-          scan_start = 1;
-          break;
-        case 2: // manual mode
-          system_state = STATE_MANUAL;
-          tracked_menu_id = menu_id;
-          break;
-        case 3: // Set freq by MHz
-          system_state = STATE_FREQ_BYMHZ;
-          tracked_menu_id = menu_id;
-          break;
-        case 4: // Favorites Menu       //gc9n
-          system_state = STATE_FAVORITE;       //gc9n
-          tracked_menu_id = menu_id;
-          break;                        //gc9n
-        case 5: // Setup Menu           //gc9n
-          system_state = STATE_SETUP_MENU;     //gc9n
-          break;                        //gc9n
-#ifdef USE_DIVERSITY
-        case 6: // Diversity
-          if (isDiversity())
-            system_state = STATE_DIVERSITY;
-          else
-          {  // Skip to next menu item
-            menu_id++;
-            system_state = STATE_SCREEN_SAVER_LITE;
-          }
-          break;
-#else
-        case 6: // Skip to next menu item
-          menu_id++;
-          system_state = STATE_SCREEN_SAVER_LITE;
-          break;
-#endif
-        case 7://Vres modelo            //gc9n
-          system_state = STATE_SCREEN_SAVER_LITE;       //gc9n
-          //drawScreen.updateScreenSaver(rssi);
-          break;
-        case 8:// OSD enable/disable  //gc9n
-          break;                        //gc9n
-      } // end switch
-
-      // draw mode select screen
-      ////Serial.println (systemState);
-      if (menu_id > 4)
-      {
-#ifdef USE_GC9N_OSD
-        drawScreen.mainMenuSecondPage(menu_id - 5, settings_OSD);
-#else
-        drawScreen.mainMenuSecondPage(menu_id - 5, false);
-#endif
-      }
-      else
-      {
-        drawScreen.mainMenu(menu_id);
-      }
-
-      while (digitalRead(buttonMode) == LOW || digitalRead(buttonUp) == LOW || digitalRead(buttonDown) == LOW  || fsButtonDirection() == 1 || fsButtonDirection() == 2)
-      {
-        // wait for MODE release
-        in_menu_time_out = 50;
-      }
-      while (--in_menu_time_out && ((digitalRead(buttonMode) == HIGH) && (digitalRead(buttonUp) == HIGH) && (digitalRead(buttonDown) == HIGH) &&  fsButtonDirection() == 0  )) // wait for next key press or time out
-      {
-        delay(100); // timeout delay
-      }
-      if (in_menu_time_out == 0 || digitalRead(buttonMode) == LOW)
-      {
-        if (menu_id == 8)
-        {
-#ifdef USE_GC9N_OSD
-          settings_OSD = !settings_OSD;
-          EEPROM.write(EEPROM_ADR_OSD, settings_OSD);
-          if (settings_OSD == false)
-          {
-            OSDParams[0] = -99; // CLEAR OSD
-            SendToOSD(); //UPDATE OSD
-          }
-          else
-          {
-            OSDParams[0] = 0; // ENABLE OSD AND GO OVER MAIN MENU OSD SELECTION
-            OSDParams[1] = 7; // OSD
-            SendToOSD(); //UPDATE OSD
-          }
-#endif
-        }
-        else
-        {
-          // Serial.read();
-          if (digitalRead(buttonMode) != LOW)
-          {  //button not pressed; timeout
-            if (state_last_used != STATE_SCAN)
-              system_state = state_last_used; // exit to last state on timeout.
-            else
-            {  //last state was bandscan; resume to manual or byMHz mode
-              system_state = (last_state_menu_id != 3) ? STATE_MANUAL :
-                                                         STATE_FREQ_BYMHZ;;
-            }
-          }
-          else  //button pressed; set id for item to be selected when menu resumed
-          {
-            last_state_menu_id = tracked_menu_id;
-                   //if auto/seek menu item selected then always start new seek
-                   // (but if timeout then will depend on 'seek_found')
-            if (system_state == STATE_SEEK)
-            {
-              force_seek = 1;
-              if (seek_found)
-                seek_found = 0;
-              else  //if "new" seek then init 'last-rssi' value
-                last_seek_rssi = 0;
-            }
-          }
-          in_menu = 0; // EXIT
-          beep(KEY_DEBOUNCE / 2); // beep & debounce
-          delay(50); // debounce
-          beep(KEY_DEBOUNCE / 2); // beep & debounce
-          delay(50); // debounce
-        }
-      }
-      else // no timeout, must be keypressed
-      {
-        /*********************/
-        /*   Menu handler   */
-        /*********************/
-
-        if (digitalRead(buttonUp) == LOW  || FS_BUTTON_DIR == 1) {
-          menu_id--;
-#ifdef USE_DIVERSITY
-          if (!isDiversity() && menu_id == 6) { // make sure we back up two menu slots.
-            menu_id--;
-          }
-#endif
-        }
-        else if (digitalRead(buttonDown) == LOW   || FS_BUTTON_DIR == 2) {
-          menu_id++;
-        }
-
-        if (menu_id > MAX_MENU_COUNT)
-        {
-          menu_id = 0; // next state
-        }
-        if (menu_id < 0)
-        {
-          menu_id = MAX_MENU_COUNT;
-        }
-
-        in_menu_time_out = 50;
-        beep(50); // beep & debounce
-        delay(KEY_DEBOUNCE); // debounce
-#ifdef USE_GC9N_OSD
-        OSDParams[0] = 0; //this is main menu
-        OSDParams[1] = menu_id + 1; //By defaut=lt goes over manual
-        SendToOSD(); //UPDATE OSD
-#endif
-      }
+      return;
     }
-    while (in_menu);
-
-    last_state = 255; // force redraw of current screen
-    switch_count = 0;
+    screen_hold_ms = 0;
+  }
 
+  if (main_menu_phase != MAIN_MENU_INACTIVE)
+  {
+    updateMainMenu();
+    return;
   }
-  else // key pressed
-  { // reset debounce
-    switch_count = 0;
+
+  /*******************/
+  /*   Mode Select   */
+  /*******************/
+  // (diversity and setup menus use the mode button themselves)
+  if (system_state != STATE_DIVERSITY && system_state != STATE_SETUP_MENU &&
+      fetchButtonEvent() == (BTN_EV_PRESS | BTN_MODE)) // key pressed ?
+  {
+    button_event = BTN_EV_NONE;
+    if (system_state == STATE_SCREEN_SAVER ||
+        system_state == STATE_SCREEN_SAVER_LITE)
+    {  //leave screen saver to last-used mode before showing menu
+      system_state = state_last_used;
+      fromScreenSaverFlag = true;
+    }
+    enterMainMenu();
+    return;
   }
 
   /***********************/
   /*     Save buttom     */
   /***********************/
   // hardware save buttom support (if no display is used)
-  if (digitalRead(buttonSave) == LOW)
+  if (fetchButtonEvent() == (BTN_EV_PRESS | BTN_SAVE))
   {
+    button_event = BTN_EV_NONE;
     system_state = STATE_SAVE;
   }
 
@@ -635,6 +649,9 @@ void loop()
   if (force_menu_redraw || system_state != last_state)
   {
     force_menu_redraw = 0;
+    screen_saver_shown_flag = false;
+    cancelAutoTune();
+    endChannelSweep();
     /************************/
     /*   Main screen draw   */
     /************************/
@@ -645,6 +662,7 @@ void loop()
     {
       case STATE_SCAN: // Band Scanner
         state_last_used = system_state;
+        // fall through
       case STATE_RSSI_SETUP: // RSSI setup
         // draw selected
         if (system_state == STATE_RSSI_SETUP)
@@ -652,14 +670,17 @@ void loop()
           // prepare new setup
           rssi_min_a = 50;
           rssi_max_a = 300; // set to max range
+          rssi_floor_a = 0;
           rssi_setup_min_a = RSSI_MAX_VAL;
           rssi_setup_max_a = RSSI_MIN_VAL;
 #ifdef USE_DIVERSITY
           rssi_min_b = 50;
           rssi_max_b = 300; // set to max range
+          rssi_floor_b = 0;
           rssi_setup_min_b = RSSI_MAX_VAL;
           rssi_setup_max_b = RSSI_MIN_VAL;
 #endif
+          updateRssiCalCurves();
           rssi_setup_run = RSSI_SETUP_RUN;
         }
 
@@ -677,7 +698,7 @@ void loop()
           if (system_state != state_last_used)
           {
             // save so state is resumed after restart
-            EEPROM.write(EEPROM_ADR_STATE, system_state);
+            writeByteToEeprom(EEPROM_ADR_STATE, system_state);
           }
               //if coming from scan or seek mode then restore previous channel:
           if (state_last_used == STATE_SCAN || state_last_used == STATE_SEEK ||
@@ -695,6 +716,8 @@ void loop()
         else //if (system_state == STATE_SEEK)
         {
           time_screen_saver = 0; // dont show screen saver until we found a channel.
+          if (!seek_found)
+            PERF_START(PERF_TMR_SEEK_LOCK);
         }
         drawScreen.seekMode(system_state);  //draw initial manual/seek screen
         updateSeekScreenFlag = true;        //update screen when entering mode
@@ -702,22 +725,33 @@ void loop()
         break;
 #ifdef USE_DIVERSITY
       case STATE_DIVERSITY:
-        // diversity menu is below this is just a place holder.
+        drawScreen.diversity(diversity_mode);
         break;
 #endif
       case STATE_SETUP_MENU:
+        setup_menu_id = 0;
+        setup_menu_editing = -1;
+        drawScreen.setupMenu();
+        drawScreen.updateSetupMenu(setup_menu_id, settings_beeps,
+                   settings_orderby_channel, call_sign, setup_menu_editing);
+#ifdef USE_GC9N_OSD
+        OSDParams[0] = 1; //this is main menu
+        OSDParams[1] = setup_menu_id + 1; //By defaut=lt goes over manual
+        requestOsdUpdate();
+#endif
+        setup_menu_time = millis();
         break;
 
       case STATE_SAVE:
-        EEPROM.write(EEPROM_ADR_CHANIDX, current_channel_index);
-        EEPROM.write(EEPROM_ADR_BEEP, settings_beeps);
-        EEPROM.write(EEPROM_ADR_ORDERBY, settings_orderby_channel);
+        writeByteToEeprom(EEPROM_ADR_CHANIDX, current_channel_index);
+        writeByteToEeprom(EEPROM_ADR_BEEP, settings_beeps);
+        writeByteToEeprom(EEPROM_ADR_ORDERBY, settings_orderby_channel);
         // save call sign
         for (uint8_t i = 0; i < sizeof(call_sign); i++) {
-          EEPROM.write(EEPROM_ADR_CALLSIGN + i, call_sign[i]);
+          writeByteToEeprom(EEPROM_ADR_CALLSIGN + i, call_sign[i]);
         }
 #ifdef USE_DIVERSITY
-        EEPROM.write(EEPROM_ADR_DIVERSITY, diversity_mode);
+        writeByteToEeprom(EEPROM_ADR_DIVERSITY, diversity_mode);
 #endif
 
         ///////////////////////FAVORITIES SAVE Gc9n
@@ -728,7 +762,7 @@ void loop()
 #ifdef USE_GC9N_OSD
           OSDParams[0] = -2; //this is save
           OSDParams[1] = 0; //By default goes over manual
-          SendToOSD(); //UPDATE OSD
+          requestOsdUpdate(); //UPDATE OSD
 #endif
           if (newFlag)
           {  //new favorite added
@@ -739,7 +773,7 @@ void loop()
           else
           {  //duplicate favorite
             drawScreen.FavSel(currentFavoritesIndex + 1);
-            delay(800);
+            holdScreen(800);
             system_state = state_last_used; // return to saved function
             force_menu_redraw = 1; // we change the state twice, must force redraw of menu
             break;
@@ -750,7 +784,7 @@ void loop()
 #ifdef USE_GC9N_OSD
           OSDParams[0] = -2; //this is save
           OSDParams[1] = 0; //By default goes over manual
-          SendToOSD(); //UPDATE OSD
+          requestOsdUpdate(); //UPDATE OSD
 #endif
           drawScreen.save(state_last_used, current_channel_index,
                           getCurrentChannelInMhz(), call_sign, -99);
@@ -762,14 +796,13 @@ void loop()
 #ifdef USE_GC9N_OSD
           OSDParams[0] = -3; //this is delete
           OSDParams[1] = 0; //By default goes over manual
-          SendToOSD(); //UPDATE OSD
+          requestOsdUpdate(); //UPDATE OSD
 #endif
 
           if (currentFavoritesIndex < currentFavoritesCount)
           {  //favorites list is not empty and index is OK
             drawScreen.FavDelete(getCurrentChannelInMhz(),
                                  currentFavoritesIndex + 1);
-            delay(500);
             if (deleteCurrentFavEntry())
             {  //list still contains entries
               int fVal;     //get current favorite (freq or freq index)
@@ -785,18 +818,14 @@ void loop()
                   current_channel_mhz = fVal;
                 saveChannelToEEPROM();
               }
-              drawScreen.FavSel(currentFavoritesIndex + 1);
             }
             //drawScreen.screenSaver(diversity_mode, channelIndexToName(channelIndex), getCurrentChannelInMhz(), call_sign);
           }
         }
 
-        for (uint8_t loop = 0; loop < 5; loop++)
-        {
-          beep(100); // beep
-          delay(100);
-        }
-        delay(300);
+        beep(100, 100, 5); // beep 5 times
+        // show save screen while beeps play (or until key pressed)
+        holdScreen(5 * (50 + 100) + 300);
         system_state = state_last_used; // return to saved function
         force_menu_redraw = 1; // we change the state twice, must force redraw of menu
 
@@ -808,16 +837,57 @@ void loop()
         state_last_used = system_state;
         break;
 
+      case STATE_FAV_SWEEP: // favorites ranked by RSSI
+        // start sweep from first favorite
+        startChannelSweep();
+        fav_sweep_done_flag = false;
+        fav_sweep_idx = 0;
+        fav_sweep_sel = 0;
+        setChannelVarsFromFavEntry(getEntryForFavIndex(fav_sweep_idx));
+        rssi_fresh_flag = false;       //wait for RSSI on new channel
+        drawScreen.favSweep(0, NULL, NULL, NULL, 0);
+        break;
+
+      case STATE_WATCH: // watch list
+        if (currentFavoritesCount == 0)
+        {  //no favorites to watch
+          drawScreen.NoFav();
+          holdScreen(1000);
+          system_state = state_last_used;
+          force_menu_redraw = 1;
+          break;
+        }
+        startChannelSweep();
+        resetWatchList();
+        watch_idx = -1;
+        if (watch_sel >= currentFavoritesCount)
+          watch_sel = 0;
+        watch_slot_time = millis() - WATCH_SLOT_MS;     //start now
+        showWatchList();
+        break;
+
       case STATE_FREQ_BYMHZ:
         time_screen_saver = millis();
         if (system_state != state_last_used)
         {
           // save so state is resumed after restart
-          EEPROM.write(EEPROM_ADR_STATE, system_state);
+          writeByteToEeprom(EEPROM_ADR_STATE, system_state);
 
+          uint8_t peakIdx;
+          // if coming from scan mode with a carrier found then tune to
+          // its estimated frequency
+          if (state_last_used == STATE_SCAN && last_state != STATE_RSSI_SETUP &&
+              getBestChannels(&peakIdx, 1) > 0 && isChannelOccupied(peakIdx))
+          {
+            current_channel_mhz = estimatePeakFreq(peakIdx);
+            current_channel_index =
+                             freqInMhzToNearestFreqIdx(current_channel_mhz, true);
+            tracking_channel_index = current_channel_index;
+          }
           // if coming from scan or seek mode then restore previous channel
-          if (state_last_used == STATE_SCAN || state_last_used == STATE_SEEK ||
-              last_state == STATE_RSSI_SETUP)
+          else if (state_last_used == STATE_SCAN ||
+                   state_last_used == STATE_SEEK ||
+                   last_state == STATE_RSSI_SETUP)
           {
             current_channel_index = EEPROM.read(EEPROM_ADR_CHANIDX);
                    //set tracking equal so tune is via 'current_channel_mhz':
@@ -831,18 +901,10 @@ void loop()
     } // end switch
 
     last_state = system_state;
-  }
 
-  // play 3 beeps to give feedback of correct start
-  if (play_startup_beeps)
-  {
-    play_startup_beeps = 0;
-#define UP_BEEP 50
-    beep(UP_BEEP);
-    delay(UP_BEEP);
-    beep(UP_BEEP);
-    delay(UP_BEEP);
-    beep(UP_BEEP);
+    // if screen is being held then wait before continuing
+    if (screen_hold_ms > 0)
+      return;
   }
 
 
@@ -855,60 +917,67 @@ void loop()
       system_state == STATE_FREQ_BYMHZ)
   {
 
-    uint16_t freqInMHz = getCurrentChannelInMhz();
-              //if freq matches table entry then show channel name
-    uint16_t chanName =
-            (getChannelFreqTableEntry(current_channel_index) == freqInMHz) ?
-                              channelIndexToName(current_channel_index) : 0;
+    if (!screen_saver_shown_flag)
+    {  //just entered; draw screen
+      uint16_t freqInMHz = getCurrentChannelInMhz();
+                //if freq matches table entry then show channel name
+      uint16_t chanName =
+              (getChannelFreqTableEntry(current_channel_index) == freqInMHz) ?
+                                channelIndexToName(current_channel_index) : 0;
 
 #ifdef USE_DIVERSITY
-    drawScreen.screenSaver(diversity_mode, chanName, freqInMHz, call_sign);
+      drawScreen.screenSaver(diversity_mode, chanName, freqInMHz, call_sign);
 #else
-    drawScreen.screenSaver(chanName, freqInMHz, call_sign);
+      drawScreen.screenSaver(chanName, freqInMHz, call_sign);
 #endif
-    time_screen_saver = millis();
-    do
-    {
-      uint8_t rssi_value = readRSSI();
-
-      if (chanChangedSaveFlag && time_screen_saver + 1000 < millis())
-      {  //unsaved channel change and enough time elapsed
-        chanChangedSaveFlag = false;
-        saveChannelToEEPROM();
+      if (auto_tune_start_mhz > 0 && !auto_tune_active_flag)
+      {  //show offset found by auto fine-tune
+        drawScreen.screenSaverAutoTune(
+                                  (int)freqInMHz - (int)auto_tune_start_mhz);
       }
+      time_screen_saver = millis();
+      screen_saver_shown_flag = true;
+    }
 
+    if (fetchButtonEvent() == BTN_EV_NONE)
+    {  //no button event; update screen
+      if (system_state == STATE_FREQ_BYMHZ)
+      {
+        updateMhzSeek();
+        updateAutoTune();
+      }
       if ( ((time_screen_saver != 0 && time_screen_saver + (SCREENSAVER_TIMEOUT * 1000) < millis())) )
       {
 #ifdef USE_GC9N_OSD
         OSDParams[0] = -99; // CLEAR OSD
-        SendToOSD(); //UPDATE OSD
+        requestOsdUpdate(); //UPDATE OSD
 #endif
         time_screen_saver = 0;
       }
 
+      if (!drawScreen.isDirty())       // update once per display refresh
+      {
 #ifdef USE_DIVERSITY
-      drawScreen.updateScreenSaver(active_receiver, rssi_value, readRSSI(useReceiverA), readRSSI(useReceiverB));
+        drawScreen.updateScreenSaver(active_receiver, current_rssi, readRSSI(useReceiverA), readRSSI(useReceiverB));
 #else
-      drawScreen.updateScreenSaver(rssi_value);
+        drawScreen.updateScreenSaver(current_rssi);
 #endif
-
-      // if 'up' or 'down' button then exit loop
-      if (digitalRead(buttonUp) == LOW || FS_BUTTON_DIR == 1 ||   // channel UP
-         (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2))  // channel DOWN
-      {
-        break;
       }
-      else  // if not 'up' or 'down' button then clear tracking flag
-        previousUpDnButtonFlag = false;
+      return;
     }
-    while (digitalRead(buttonMode) == HIGH);     // wait for next button press
+    screen_saver_shown_flag = false;
     system_state = state_last_used;
     fromScreenSaverFlag = true;
 
-    // if screen saver then exit 'loop()' function here
-    // also exit if mode button to get to menu processing without delay
-    if (system_state != STATE_FREQ_BYMHZ || digitalRead(buttonMode) == LOW)
+    // if screen saver then exit here (button event is left pending for
+    // the next step); continue only for 'up' or 'down' button in
+    // Set-by-MHz mode
+    if (system_state != STATE_FREQ_BYMHZ ||
+        (BTN_EV_BUTTON(button_event) != BTN_UP &&
+         BTN_EV_BUTTON(button_event) != BTN_DOWN))
+    {
       return;
+    }
   }
 #endif
 
@@ -916,43 +985,40 @@ void loop()
   if (system_state == STATE_DIVERSITY)
   {
     // simple menu
-    char menu_id = diversity_mode;
-    uint8_t in_div_menu = 1;
-    do
+    const uint8_t div_menu_event = fetchButtonEvent();
+    if (div_menu_event == BTN_EV_NONE)
+    {  //no key; update screen (once per display refresh)
+      if (!drawScreen.isDirty())
+        drawScreen.updateDiversity(active_receiver, readRSSI(useReceiverA), readRSSI(useReceiverB), getDivSwitchesPerMinute());
+    }
+    else
     {
-      diversity_mode = menu_id;
-      drawScreen.diversity(diversity_mode);
-      do
-      {
-        //delay(10); // timeout delay
-        readRSSI();
-        drawScreen.updateDiversity(active_receiver, readRSSI(useReceiverA), readRSSI(useReceiverB));
-      }
-      while ((digitalRead(buttonMode) == HIGH) && (digitalRead(buttonUp) == HIGH) && (digitalRead(buttonDown) == HIGH) &&  fsButtonDirection() == 0 ); // wait for next mode or time out
-
-      if (digitalRead(buttonMode) == LOW)       // channel UP
+      button_event = BTN_EV_NONE;
+      char menu_id = diversity_mode;
+      if (BTN_EV_BUTTON(div_menu_event) == BTN_MODE)
       {
-        in_div_menu = 0; // exit menu
+        system_state = state_last_used; // exit menu
       }
-      else if (digitalRead(buttonUp) == LOW || FS_BUTTON_DIR == 1) {
+      else if (BTN_EV_BUTTON(div_menu_event) == BTN_UP) {
         menu_id--;
       }
-      else if (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2) {
+      else if (BTN_EV_BUTTON(div_menu_event) == BTN_DOWN) {
         menu_id++;
       }
 
-      if (menu_id > useReceiverB) {
+      if (menu_id > useReceiverPredict) {
         menu_id = 0;
       }
       if (menu_id < 0) {
-        menu_id = useReceiverB;
+        menu_id = useReceiverPredict;
+      }
+      beep(50); // beep
+      if (system_state == STATE_DIVERSITY && menu_id != diversity_mode)
+      {
+        diversity_mode = menu_id;
+        drawScreen.diversity(diversity_mode);
       }
-      beep(50); // beep & debounce
-      delay(KEY_DEBOUNCE); // debounce
     }
-    while (in_div_menu);
-
-    system_state = state_last_used;
   }
 #endif
 
@@ -965,17 +1031,22 @@ void loop()
     {  //favorites list is not empty
       if (favModeInProgressFlag)
       {  //did not just enter mode
-        // read rssi
-        wait_rssi_ready();
-        uint8_t rssi_value = readRSSI();
         time_screen_saver = millis();
 
         // handling of keys
-        bool upFlag = (digitalRead(buttonUp) == LOW || FS_BUTTON_DIR == 1);    // channel UP
-        bool dnFlag = (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2);  // channel DOWN
-
-        if ((upFlag || dnFlag) && !(upFlag && dnFlag))
-        {  //UP or DOWN key pressed (but not both)
+        bool upFlag = (button_event == (BTN_EV_PRESS | BTN_UP));      // channel UP
+        bool dnFlag = (button_event == (BTN_EV_PRESS | BTN_DOWN));    // channel DOWN
+
+        if (button_event == (BTN_EV_PRESS | BTN_UP_DOWN))
+        {  //UP and DOWN pressed together; rank favorites by RSSI
+          button_event = BTN_EV_NONE;
+          beep(50);
+          system_state = STATE_FAV_SWEEP;
+          return;
+        }
+        if (upFlag || dnFlag)
+        {  //UP or DOWN key pressed
+          button_event = BTN_EV_NONE;
           //switch to next or previous entries in favorites list
           nextOrPrevFavEntry(upFlag);
           time_screen_saver = millis();
@@ -1003,15 +1074,14 @@ void loop()
             saveChannelToEEPROM();
           }
           drawScreen.FavSel(currentFavoritesIndex + 1);
-          delay(KEY_DEBOUNCE); // debounce
-          beep(50); // beep & debounce
-          delay(KEY_DEBOUNCE); // debounce
+          beep(50); // beep
+          holdScreen(200); // keep favorite ID on screen briefly
         }
         system_state = STATE_SCREEN_SAVER;
       }
       else
       {  //mode was just entered
-        EEPROM.write(EEPROM_ADR_STATE, STATE_FAVORITE);
+        writeByteToEeprom(EEPROM_ADR_STATE, STATE_FAVORITE);
         favModeInProgressFlag = true;
               //get current channel index or frequency in MHz value:
         int fVal = (current_channel_mhz == 0) ?
@@ -1038,71 +1108,178 @@ void loop()
         }
               //show favorite ID value to user:
         drawScreen.FavSel(currentFavoritesIndex + 1);
-        delay(500);
+        holdScreen(500);
       }
     }
     else
     {  //favorites list is empty
       drawScreen.NoFav();
-      delay(1000);
+      holdScreen(1000);
       system_state = STATE_SCREEN_SAVER;
             //revert to non-Favorites mode:
       state_last_used = (current_channel_mhz == 0) ? STATE_MANUAL :
                                                      STATE_FREQ_BYMHZ;
-      EEPROM.write(EEPROM_ADR_STATE, state_last_used);
+      writeByteToEeprom(EEPROM_ADR_STATE, state_last_used);
       last_state_menu_id = (state_last_used == STATE_MANUAL) ? 2 : 3;
     }
 
 #ifdef USE_GC9N_OSD
     OSDParams[0] = 4; //this is FAV menu
     OSDParams[1] = getCurrentChannelInMhz();
-    OSDParams[2] = lfavs + 1;
-    SendToOSD(); //UPDATE OSD
+    OSDParams[2] = currentFavoritesIndex + 1;
+    requestOsdUpdate(); //UPDATE OSD
 #endif
   }
 
 
+  /*****************************************/
+  /*   Processing FAVORITES SWEEP          */
+  /*****************************************/
+  if (system_state == STATE_FAV_SWEEP)
+  {
+    const uint8_t evType = BTN_EV_TYPE(button_event);
+    if (currentFavoritesCount == 0)
+    {  //no favorites to sweep
+      system_state = state_last_used;
+    }
+    else if (fav_sweep_done_flag && button_event == (BTN_EV_PRESS | BTN_UP))
+    {  //UP selects favorite at cursor (strongest unless moved)
+      button_event = BTN_EV_NONE;
+      beep(50);
+      currentFavoritesIndex = fav_sweep_rank[fav_sweep_sel];
+      writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
+      sweep_restore_flag = false;      //stay on selected favorite
+      setChannelVarsFromFavEntry(getEntryForFavIndex(currentFavoritesIndex));
+      favModeInProgressFlag = false;   //show selected favorite
+      system_state = STATE_FAVORITE;
+    }
+    else if (fav_sweep_done_flag && BTN_EV_BUTTON(button_event) == BTN_DOWN &&
+             (evType == BTN_EV_PRESS || evType == BTN_EV_REPEAT))
+    {  //DOWN moves cursor down the ranking
+      button_event = BTN_EV_NONE;
+      if (evType == BTN_EV_PRESS)
+        beep(50);
+      if (++fav_sweep_sel >= currentFavoritesCount)
+        fav_sweep_sel = 0;
+      showFavSweepRanking();
+    }
+    else if (rssi_fresh_flag)
+    {  //favorite measured; on to next one (ranking shown after each sweep)
+      rssi_fresh_flag = false;
+      fav_sweep_rssi[fav_sweep_idx] = current_rssi;
+      if (++fav_sweep_idx >= currentFavoritesCount)
+      {
+        fav_sweep_idx = 0;
+        fav_sweep_done_flag = true;
+        showFavSweepRanking();
+      }
+      setChannelVarsFromFavEntry(getEntryForFavIndex(fav_sweep_idx));
+    }
+  }
+
+
+  /*****************************************/
+  /*   Processing WATCH LIST               */
+  /*****************************************/
+  if (system_state == STATE_WATCH)
+  {
+    const uint8_t evType = BTN_EV_TYPE(button_event);
+    if (button_event == (BTN_EV_PRESS | BTN_UP))
+    {  //UP adds or removes favorite at cursor
+      button_event = BTN_EV_NONE;
+      beep(50);
+      watch_mask ^= (uint16_t)1 << watch_sel;
+      writeWordToEeprom(EEPROM_ADRW_WATCHMASK, watch_mask);
+      resetWatchChannel(watch_sel);
+      watch_redraw_flag = true;
+    }
+    else if (BTN_EV_BUTTON(button_event) == BTN_DOWN &&
+             (evType == BTN_EV_PRESS || evType == BTN_EV_REPEAT))
+    {  //DOWN moves cursor to next favorite
+      button_event = BTN_EV_NONE;
+      if (evType == BTN_EV_PRESS)
+        beep(50);
+      if (++watch_sel >= currentFavoritesCount)
+        watch_sel = 0;
+      watch_redraw_flag = true;
+    }
+
+    if (rssi_fresh_flag && !watch_sampled_flag && watch_idx >= 0)
+    {  //first RSSI after tuner settled in this slot
+      rssi_fresh_flag = false;
+      watch_sampled_flag = true;
+      if (watch_mask & ((uint16_t)1 << watch_idx))
+        addWatchSample(watch_idx, current_rssi);
+    }
+    if ((watch_sampled_flag || watch_idx < 0) &&
+        millis() - watch_slot_time >= WATCH_SLOT_MS)
+    {  //slot over (and sampled); on to next watched favorite (keeping
+       // a fixed rate unless the sample came late)
+      watch_slot_time += WATCH_SLOT_MS;
+      if (millis() - watch_slot_time >= WATCH_SLOT_MS)
+        watch_slot_time = millis();    //fell behind (display or key)
+      const int nextIdx = nextWatchIndex(watch_idx);
+      if (nextIdx >= 0 && nextIdx <= watch_idx)
+      {  //round done
+        markWatchRound();
+        watch_redraw_flag = true;
+      }
+      watch_idx = nextIdx;
+      if (watch_idx >= 0)
+        setChannelVarsFromFavEntry(getEntryForFavIndex(watch_idx));
+      rssi_fresh_flag = false;
+      watch_sampled_flag = false;
+    }
+    if (watch_redraw_flag && !drawScreen.isDirty())
+      showWatchList();
+  }
+
+
   /*****************************************/
   /*   Processing Set Freq by MHz          */
   /*****************************************/
   if (system_state == STATE_FREQ_BYMHZ)
   {
-    static int buttonDelayValue = KEY_DEBOUNCE;
-
 //    OSDParams[0] = 3;
 
     // if just entered mode then set initial MHz value via table index
     if (current_channel_mhz == 0)
       current_channel_mhz = getChannelFreqTableEntry(current_channel_index);
 
-    // handling of keys
-    bool upFlag = (digitalRead(buttonUp) == LOW || FS_BUTTON_DIR == 1);    // channel UP
-    bool dnFlag = (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2);  // channel DOWN
+    if (button_event == (BTN_EV_PRESS | BTN_UP_DOWN))
+    {  //UP and DOWN pressed together; start auto fine-tune
+      button_event = BTN_EV_NONE;
+      time_screen_saver = millis();
+      beep(50);
+      auto_tune_request_flag = true;
+      return;
+    }
+
+    // handling of keys; holding a button auto-repeats with progressive
+    // speedup, and at full speed steps by 10 MHz
+    bool upFlag = (BTN_EV_BUTTON(button_event) == BTN_UP);      // channel UP
+    bool dnFlag = (BTN_EV_BUTTON(button_event) == BTN_DOWN);    // channel DOWN
 
-    if ((upFlag || dnFlag) && !(upFlag && dnFlag))
-    {  //UP or DOWN key pressed (but not both)
+    if (upFlag || dnFlag)
+    {  //UP or DOWN key pressed or auto-repeating
       time_screen_saver = millis();
 
-      if (!previousUpDnButtonFlag)
-      {  //button press is "new"
-        beep(50);  // beep & debounce
-        buttonDelayValue = KEY_DEBOUNCE;
-        previousUpDnButtonFlag = true;
-      }
-      else
-      {  //button is being held down, do progressive mod speedup
-        if (buttonDelayValue > 20)
-          buttonDelayValue -= 20;
-        else if (buttonDelayValue > 0)
-          --buttonDelayValue;
+      const uint8_t evType = BTN_EV_TYPE(button_event);
+      button_event = BTN_EV_NONE;
+      if (evType == BTN_EV_PRESS)
+        beep(50);  // beep on new button press
+      else if (auto_tune_request_flag || auto_tune_start_mhz > 0 ||
+               mhz_seek_request_flag || mhz_seek_active_flag)
+      {
+        return;        //ignore auto-repeat of keys held for fine-tune
       }
-      if (buttonDelayValue > 0)
-        delay(buttonDelayValue);  // debounce
-
-      FS_BUTTON_DIR = 0;
+          // new press cancels seek or fine-tune (back to start) and
+          //  clears result
+      auto_tune_request_flag = mhz_seek_request_flag = false;
+      cancelAutoTune();
       if (upFlag)
       {
-        if (buttonDelayValue > 0)
+        if (evType != BTN_EV_REPEAT_FAST)
           ++current_channel_mhz;
         else
           current_channel_mhz = (current_channel_mhz + 10) / 10 * 10;
@@ -1111,7 +1288,7 @@ void loop()
       }
       else
       {
-        if (buttonDelayValue > 0)
+        if (evType != BTN_EV_REPEAT_FAST)
           --current_channel_mhz;
         else
           current_channel_mhz = (current_channel_mhz - 1) / 10 * 10;
@@ -1135,13 +1312,11 @@ void loop()
 //      if (OSDParams[1]!=getCurrentChannelInMhz())
 //      {
 //        OSDParams[1]=getCurrentChannelInMhz();
-//        SendToOSD(); //UPDATE OSD
+//        requestOsdUpdate(); //UPDATE OSD
 //      }
 //#endif
 
     }
-    else
-      previousUpDnButtonFlag = false;
   }
 
 
@@ -1156,11 +1331,9 @@ void loop()
       setTunerToCurrentChannel();
       chanChangedSaveFlag = true;      //channel changed and needs to be saved
     }
-    // read rssi
-    wait_rssi_ready();
-    uint8_t rssi_value = readRSSI();
-    FS_BUTTON_DIR = fsButtonDirection();
-    
+    // latest rssi
+    uint8_t rssi_value = current_rssi;
+
     channel_sort_idx = getChannelSortTableIndex(current_channel_index); // get 0...47 index depending of current channel
     if (system_state == STATE_MANUAL) // MANUAL MODE
     {
@@ -1169,13 +1342,35 @@ void loop()
       OSDParams[0] = 3; //this is MANUAL MODE
 #endif
 
-      // handling of keys
-      if ( digitalRead(buttonUp) == LOW  || FS_BUTTON_DIR == 1 )       // channel UP
+      if (button_event == (BTN_EV_PRESS | BTN_UP_DOWN))
+      {  //UP and DOWN pressed together; go to next free channel (scanned
+         // and not occupied)
+        time_screen_saver = millis();
+        button_event = BTN_EV_NONE;
+        beep(50); // beep
+        const int freeIdx = getNextFreeChannel(current_channel_index, true);
+        if (freeIdx >= 0)
+        {
+          current_channel_index = (uint8_t)freeIdx;
+          channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+          chanChangedSaveFlag = true;  //channel changed and needs to be saved
+        }
+      }
+
+      // handling of keys (holding a button auto-repeats)
+      const uint8_t evType = BTN_EV_TYPE(button_event);
+      const bool stepFlag = (evType == BTN_EV_PRESS || evType == BTN_EV_REPEAT ||
+                             evType == BTN_EV_REPEAT_FAST);
+      if (stepFlag && BTN_EV_BUTTON(button_event) == BTN_UP)     // channel UP
       {
         time_screen_saver = millis();
-        beep(50); // beep & debounce
-        delay(KEY_DEBOUNCE); // debounce
-        FS_BUTTON_DIR=0;
+        button_event = BTN_EV_NONE;
+        if (evType == BTN_EV_PRESS)
+          beep(50); // beep on new button press
+#ifdef USE_PRETUNE
+        pretune_up_flag = true;
+        pretune_step_time = millis();
+#endif
         current_channel_index++;
         channel_sort_idx++;
         if (channel_sort_idx > CHANNEL_MAX)
@@ -1184,12 +1379,16 @@ void loop()
           current_channel_index = CHANNEL_MIN_INDEX;
         chanChangedSaveFlag = true;    //channel changed and needs to be saved
       }
-      if ( digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2 ) // channel DOWN
+      if (stepFlag && BTN_EV_BUTTON(button_event) == BTN_DOWN)   // channel DOWN
       {
         time_screen_saver = millis();
-        beep(50); // beep & debounce
-        delay(KEY_DEBOUNCE); // debounce
-        FS_BUTTON_DIR=0;
+        button_event = BTN_EV_NONE;
+        if (evType == BTN_EV_PRESS)
+          beep(50); // beep on new button press
+#ifdef USE_PRETUNE
+        pretune_up_flag = false;
+        pretune_step_time = millis();
+#endif
         current_channel_index--;
         channel_sort_idx--;
         if (channel_sort_idx < CHANNEL_MIN)
@@ -1203,7 +1402,7 @@ void loop()
       if (OSDParams[1] != getCurrentChannelInMhz())
       {
         OSDParams[1] = getCurrentChannelInMhz();
-        SendToOSD(); //UPDATE OSD
+        requestOsdUpdate(); //UPDATE OSD
       }
 #endif
 
@@ -1222,91 +1421,127 @@ void loop()
       OSDParams[0] = 2; //this is AUTO MODE
 #endif
 
-      if (!seek_found) // search if not found
+      // wait for RSSI from newly-tuned channel
+      if (!seek_found && rssi_fresh_flag) // search if not found
       {
+        rssi_fresh_flag = false;
+        addScanResult(current_channel_index, rssi_value);
+        if (force_seek)
+        {  //seek restarted
+          seek_check_flag = false;
+          for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+            seek_warm_bits[i] = 0;     //no warm start (seek by key)
+          updateSeekThreshold();
+          PERF_START(PERF_TMR_SEEK_LOCK);
+        }
+        bool check_done_flag = false;
+        if (seek_check_flag)
+        {  //checking if next channels have higher RSSI than 'found' channel
+          if (rssi_value > seek_check_rssi)
+          {  //next channel has higher RSSI; accept channel, and continue
+            seek_check_sort_idx = channel_sort_idx;
+            seek_check_rssi = rssi_value;
+            updateSeekScreenFlag = true;    //update channel shown on screen
+          }
+          else
+          {  //next channel does not have higher RSSI; go back to best one
+            channel_sort_idx = seek_check_sort_idx;
+            current_channel_index = getChannelSortTableEntry(channel_sort_idx);
+            check_done_flag = true;
+          }
+        }
         // if seek was not just initiated then check if RSSI level is high
         //  enough for 'found' channel (and beyond previous 'found' channel)
-        if ((!force_seek) && rssi_value > RSSI_SEEK_TRESHOLD &&
-                                       last_seek_rssi <= RSSI_SEEK_TRESHOLD)
-        {
-          seek_found = 1;
-              //check if next channels have higher RSSI
-          char chkIdx = channel_sort_idx;
-          uint8_t preChIdx = current_channel_index;
-          uint8_t chkRssiVal;
-          while (true)
-          {
-            if (seek_forward_flag)
-            {
-              if (++chkIdx > CHANNEL_MAX)
-                break;
-            }
-            else
-            {
-              if (--chkIdx < CHANNEL_MIN)
-                break;
-            }
-            current_channel_index = getChannelSortTableEntry(chkIdx);
-            setTunerToCurrentChannel();
-            wait_rssi_ready();
-            chkRssiVal = readRSSI();
-            if (chkRssiVal <= rssi_value)
-            {  //next channel does not have higher RSSI
-              current_channel_index = preChIdx;
-              setTunerToCurrentChannel();
-              break;
-            }
-              //next channel has higher RSSI; accept channel, and loop
-            channel_sort_idx = chkIdx;
-            preChIdx = current_channel_index;
-            rssi_value = chkRssiVal;
-            updateSeekScreenFlag = true;    //update channel shown on screen
-          }
-          time_screen_saver = millis();
-          chanChangedSaveFlag = true;  //channel changed and needs to be saved
-          // beep twice as notice of lock
-         // beep(100);
-         // delay(100);
-        //  beep(100);
+        else if ((!force_seek) && rssi_value > getSeekThreshold() &&
+                                       last_seek_rssi <= getSeekThreshold())
+        {  //start checking if next channels have higher RSSI
+          seek_check_flag = true;
+          seek_check_sort_idx = channel_sort_idx;
+          seek_check_rssi = rssi_value;
         }
         else
         { // seeking itself
           force_seek = 0;
-          // next channel
-          if (seek_forward_flag)
+          // next channel (or next channel occupied last session)
+          const char warmIdx = nextWarmSeekChannel();
+          if (warmIdx >= 0)
+            channel_sort_idx = warmIdx;
+          else if (seek_forward_flag)
           {
             if (++channel_sort_idx > CHANNEL_MAX)
+            {  //sweep done; adapt threshold to latest noise floor
               channel_sort_idx = CHANNEL_MIN;
+              updateSeekThreshold();
+              occupancy_save_flag = true;
+            }
           }
           else
           {
             if (--channel_sort_idx < CHANNEL_MIN)
+            {
               channel_sort_idx = CHANNEL_MAX;
+              updateSeekThreshold();
+              occupancy_save_flag = true;
+            }
           }
           current_channel_index = getChannelSortTableEntry(channel_sort_idx);
         }
+
+        if (seek_check_flag && !check_done_flag)
+        {  //move to next channel to be checked (if any)
+          char chkIdx = seek_forward_flag ? channel_sort_idx + 1 :
+                                            channel_sort_idx - 1;
+          if (chkIdx >= CHANNEL_MIN && chkIdx <= CHANNEL_MAX)
+          {
+            channel_sort_idx = chkIdx;
+            current_channel_index = getChannelSortTableEntry(chkIdx);
+          }
+          else
+            check_done_flag = true;
+        }
+        if (check_done_flag)
+        {  //done checking; seek was successful
+          seek_check_flag = false;
+          seek_found = 1;
+          occupancy_save_flag = true;
+          PERF_STOP(PERF_TMR_SEEK_LOCK);
+          rssi_value = seek_check_rssi;
+          updateSeekScreenFlag = true;
+          time_screen_saver = millis();
+          chanChangedSaveFlag = true;  //channel changed and needs to be saved
+          // beep twice as notice of lock
+         // beep(100);
+         // delay(100);
+        //  beep(100);
+        }
+        last_seek_rssi = rssi_value;
       }
-      // else  //seek was successful
+      // else  //seek was successful (or waiting for RSSI)
 
       // handling of keys
-      bool upFlag = (digitalRead(buttonUp) == LOW || FS_BUTTON_DIR == 1);    // channel UP
-      bool dnFlag = (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2);  // channel DOWN
-
-      if ((upFlag || dnFlag) && !(upFlag && dnFlag))
-      {  //UP or DOWN key pressed (but not both); restart seek
+      bool upFlag = (button_event == (BTN_EV_PRESS | BTN_UP));      // channel UP
+      bool dnFlag = (button_event == (BTN_EV_PRESS | BTN_DOWN));    // channel DOWN
+
+      if (button_event == (BTN_EV_PRESS | BTN_UP_DOWN))
+      {  //UP and DOWN pressed together; seek by MHz (in Set by MHz mode)
+        button_event = BTN_EV_NONE;
+        beep(50);
+        system_state = STATE_FREQ_BYMHZ;
+        last_state_menu_id = 3;
+        mhz_seek_request_flag = true;
+      }
+      else if (upFlag || dnFlag)
+      {  //UP or DOWN key pressed; restart seek
+        button_event = BTN_EV_NONE;
         seek_forward_flag = upFlag;
-        beep(50); // beep & debounce
-        FS_BUTTON_DIR = 0;
-        delay(KEY_DEBOUNCE); // debounce
+        beep(50); // beep
         force_seek = 1;
         seek_found = 0;
         time_screen_saver = 0;
       }
 
-      last_seek_rssi = rssi_value;
-
 #ifdef USE_GC9N_OSD
-      SendToOSD(); //UPDATE OSD
+      requestOsdUpdate(); //UPDATE OSD
 #endif
     }
 
@@ -1318,17 +1553,17 @@ void loop()
       system_state = STATE_SCREEN_SAVER;
 #ifdef USE_GC9N_OSD
       OSDParams[0] = -99; // CLEAR OSD
-      SendToOSD(); //UPDATE OSD
+      requestOsdUpdate(); //UPDATE OSD
 #endif
     }
   
     //teza
     if (last_channel_index != current_channel_index || updateSeekScreenFlag)
     {
-      drawScreen.updateSeekMode(system_state, current_channel_index, channel_sort_idx, rssi_value, getCurrentChannelInMhz(), RSSI_SEEK_TRESHOLD, seek_found);
+      drawScreen.updateSeekMode(system_state, current_channel_index, channel_sort_idx, rssi_value, getCurrentChannelInMhz(), getSeekThreshold(), seek_found);
 #ifdef USE_GC9N_OSD
       OSDParams[1] = getCurrentChannelInMhz();
-      SendToOSD(); //UPDATE OSD
+      requestOsdUpdate(); //UPDATE OSD
 #endif
       updateSeekScreenFlag = false;
       if (seek_found)                  //cover case where seek screen restored
@@ -1345,7 +1580,7 @@ void loop()
   {
 #ifdef USE_GC9N_OSD
     OSDParams[0] = -1; //N/A for the moment
-    SendToOSD(); //UPDATE OSD
+    requestOsdUpdate(); //UPDATE OSD
 #endif
 
     // force tune on new scan start to get right RSSI value
@@ -1353,75 +1588,209 @@ void loop()
     {
       scan_start = 0;
       current_channel_mhz = 0;      // tune via 'current_channel_index'
-      setChannelByIdx(current_channel_index);
-      last_channel_index = current_channel_index;
+      last_channel_index = 0xFF;    // retune even if same channel
+      scan_revisit_count = 0;
+      scan_revisit_idx = -1;
+      scan_down_flag = false;
+#ifdef slaveSelectPinB
+      scan_revisit_idx_b = -1;
+#endif
+#ifdef slaveSelectPinB
+          // receiver B scans alongside A if diversity module present
+          // (not in RSSI setup; both must see same channel to calibrate)
+      dual_scan_flag = (system_state == STATE_SCAN && isDiversity());
+#endif
+      PERF_START(PERF_TMR_SCAN_SWEEP);
     }
 
-    // print bar for spectrum
-    wait_rssi_ready();
-    // value must be ready
-    uint8_t rssi_value = readRSSI();
-
-    uint16_t scanChannelName = channelIndexToName(current_channel_index);
-    uint16_t scanChannelFrequency = getCurrentChannelInMhz();
-
-    drawScreen.updateBandScanMode((system_state == STATE_RSSI_SETUP), channel_sort_idx, rssi_value, scanChannelName, scanChannelFrequency, rssi_setup_min_a, rssi_setup_max_a);
-
-    // next channel
-    if (channel_sort_idx < CHANNEL_MAX)
+    // update bar of busy channel measured again out of sweep order
+    if (rssi_fresh_flag && scan_revisit_idx >= 0)
     {
-      channel_sort_idx++;
+      rssi_fresh_flag = false;
+      const uint8_t sortIdx = getChannelSortTableIndex(scan_revisit_idx);
+      drawScreen.updateBandScanBar(sortIdx, current_rssi);
+      addScanResult(scan_revisit_idx, current_rssi);
+      drawScreen.updateBandScanImdFlag(sortIdx,
+                                      checkImdProduct(scan_revisit_idx));
+      scan_revisit_idx = -1;
+#ifdef slaveSelectPinB
+      if (last_channel_index_b != 0xFF)
+      {  //receiver B measured another busy channel
+        const uint8_t sortIdxB = getChannelSortTableIndex(last_channel_index_b);
+        drawScreen.updateBandScanBar(sortIdxB, current_rssi_b);
+        addScanResult(last_channel_index_b, current_rssi_b);
+        drawScreen.updateBandScanImdFlag(sortIdxB,
+                                  checkImdProduct(last_channel_index_b));
+      }
+      scan_revisit_idx_b = -1;
+#endif
     }
-    else
+
+    // print bar for spectrum (once RSSI from newly-tuned channel ready)
+    if (rssi_fresh_flag)
     {
-      channel_sort_idx = CHANNEL_MIN;
-      if (system_state == STATE_RSSI_SETUP)
+      rssi_fresh_flag = false;
+      uint8_t rssi_value = current_rssi;
+
+      uint16_t scanChannelName = channelIndexToName(current_channel_index);
+      uint16_t scanChannelFrequency = getCurrentChannelInMhz();
+
+      drawScreen.updateBandScanMode((system_state == STATE_RSSI_SETUP), channel_sort_idx, rssi_value, scanChannelName, scanChannelFrequency, rssi_setup_min_a, rssi_setup_max_a);
+      if (system_state == STATE_SCAN)
+      {  //record result and flag if intermodulation product
+        addScanResult(current_channel_index, rssi_value);
+        drawScreen.updateBandScanImdFlag(channel_sort_idx,
+                                checkImdProduct(current_channel_index));
+      }
+#ifdef slaveSelectPinB
+      if (last_channel_index_b != 0xFF)
+      {  //receiver B was tuned to next channel; show its bar too
+        channel_sort_idx += scan_down_flag ? -1 : 1;
+        drawScreen.updateBandScanMode(false, channel_sort_idx, current_rssi_b, channelIndexToName(last_channel_index_b), getChannelFreqTableEntry(last_channel_index_b), rssi_setup_min_a, rssi_setup_max_a);
+        addScanResult(last_channel_index_b, current_rssi_b);
+        drawScreen.updateBandScanImdFlag(channel_sort_idx,
+                                checkImdProduct(last_channel_index_b));
+      }
+#endif
+
+      // every so often measure an occupied or changing channel again
+      if (system_state == STATE_SCAN &&
+          ++scan_revisit_count >= SCAN_REVISIT_INTERVAL)
       {
-        if (!rssi_setup_run--)
-        {  // setup done
-          rssi_min_a = rssi_setup_min_a;
-          writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_A, rssi_min_a);
-              //if 'max' is close to 'min' then user probably
-              // did not turn on the VTX during calibration
-          if (rssi_setup_max_a - rssi_setup_min_a >= rssi_setup_min_a/3)
-          {  //difference is high enough to use
-            rssi_max_a = rssi_setup_max_a;
-            writeWordToEeprom(EEPROM_ADRW_RSSI_MAX_A, rssi_max_a);
-          }
+        scan_revisit_count = 0;
+        scan_revisit_idx = getNextRevisitChannel();
+#ifdef slaveSelectPinB
+        if (dual_scan_flag && scan_revisit_idx >= 0)
+        {  //receiver B measures the next busy channel (if another)
+          scan_revisit_idx_b = getNextRevisitChannel();
+          if (scan_revisit_idx_b == scan_revisit_idx)
+            scan_revisit_idx_b = -1;
+        }
+#endif
+      }
 
-#ifdef USE_DIVERSITY
-          if (isDiversity())
-          {  // only calibrate RSSI B when diversity is detected.
-            rssi_min_b = rssi_setup_min_b;
-            writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_B, rssi_min_b);
-              //if 'max' is close to 'min' then user probably
-              // did not turn on the VTX during calibration
-            if (rssi_setup_max_b - rssi_setup_min_b >= rssi_setup_min_b/3)
+      // next channel; sweeps go up and down in turn so the tuner never
+      //  hops across the band (the end channel is measured again, which
+      //  needs no tune)
+      if (scan_down_flag ? (channel_sort_idx > CHANNEL_MIN) :
+                           (channel_sort_idx < CHANNEL_MAX))
+      {
+        channel_sort_idx += scan_down_flag ? -1 : 1;
+      }
+      else
+      {
+        scan_down_flag = !scan_down_flag;
+        if (system_state == STATE_SCAN)
+        {
+          drawScreen.bandScanSweepDone();
+          occupancy_save_flag = true;
+        }
+        PERF_STOP(PERF_TMR_SCAN_SWEEP);
+        PERF_START(PERF_TMR_SCAN_SWEEP);
+        if (system_state == STATE_RSSI_SETUP)
+        {
+          if (!rssi_setup_run--)
+          {  // setup done
+            rssi_min_a = rssi_setup_min_a;
+            writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_A, rssi_min_a);
+            rssi_floor_a = rssi_setup_floor_a;
+            writeWordToEeprom(EEPROM_ADRW_RSSI_FLOOR_A, rssi_floor_a);
+                //if 'max' is close to 'min' then user probably
+                // did not turn on the VTX during calibration
+            if (rssi_setup_max_a - rssi_setup_min_a >= rssi_setup_min_a/3)
             {  //difference is high enough to use
-              rssi_max_b = rssi_setup_max_b;
-              writeWordToEeprom(EEPROM_ADRW_RSSI_MAX_B, rssi_max_b);
+              rssi_max_a = rssi_setup_max_a;
+              writeWordToEeprom(EEPROM_ADRW_RSSI_MAX_A, rssi_max_a);
             }
+
+  #ifdef USE_DIVERSITY
+            if (isDiversity())
+            {  // only calibrate RSSI B when diversity is detected.
+              rssi_min_b = rssi_setup_min_b;
+              writeWordToEeprom(EEPROM_ADRW_RSSI_MIN_B, rssi_min_b);
+              rssi_floor_b = rssi_setup_floor_b;
+              writeWordToEeprom(EEPROM_ADRW_RSSI_FLOOR_B, rssi_floor_b);
+                //if 'max' is close to 'min' then user probably
+                // did not turn on the VTX during calibration
+              if (rssi_setup_max_b - rssi_setup_min_b >= rssi_setup_min_b/3)
+              {  //difference is high enough to use
+                rssi_max_b = rssi_setup_max_b;
+                writeWordToEeprom(EEPROM_ADRW_RSSI_MAX_B, rssi_max_b);
+              }
+              finishRssiMatch();       //save receiver B-to-A offsets
+              for (uint8_t i = 0; i < RSSI_MATCH_BANDS; ++i)
+              {
+                writeByteToEeprom(EEPROM_ADRA_RSSI_MATCH + i,
+                                  (uint8_t)getRssiMatchOffset(i));
+              }
+            }
+  #endif
+            updateRssiCalCurves();     //use new calibration values
+            system_state = EEPROM.read(EEPROM_ADR_STATE);
+            beep(1000);
+          }
+          else if (rssi_setup_run == 1)
+          {  //next-to-last sweep; measure noise floor (min/max found)
+            startRssiFloor(RSSI_CAL_RCVR_A, rssi_setup_min_a, rssi_setup_max_a);
+  #ifdef USE_DIVERSITY
+            startRssiFloor(RSSI_CAL_RCVR_B, rssi_setup_min_b, rssi_setup_max_b);
+  #endif
+          }
+          else if (rssi_setup_run == 0)
+          {  //last sweep; use curves from the values found so far (and
+             // measure receivers against each other)
+            rssi_setup_floor_a = finishRssiFloor(RSSI_CAL_RCVR_A);
+            setRssiCalRange(RSSI_CAL_RCVR_A, rssi_setup_min_a,
+                            rssi_setup_floor_a, rssi_setup_max_a);
+  #ifdef USE_DIVERSITY
+            rssi_setup_floor_b = finishRssiFloor(RSSI_CAL_RCVR_B);
+            setRssiCalRange(RSSI_CAL_RCVR_B, rssi_setup_min_b,
+                            rssi_setup_floor_b, rssi_setup_max_b);
+            startRssiMatch();
+  #endif
           }
-#endif
-          system_state = EEPROM.read(EEPROM_ADR_STATE);
-          beep(1000);
         }
       }
     }
+    // show race-channel plan from scan results
+    if (button_event == (BTN_EV_PRESS | BTN_DOWN) &&
+                                           system_state == STATE_SCAN)
+    {
+      button_event = BTN_EV_NONE;
+      beep(50); // beep
+      startRacePlan(RACE_PLAN_PILOTS);
+      race_plan_flag = true;
+    }
     // new scan possible by press scan
-    FS_BUTTON_DIR = fsButtonDirection();
-    if (digitalRead(buttonUp) == LOW ||  FS_BUTTON_DIR == 1) // force new full new scan
+    if (button_event == (BTN_EV_PRESS | BTN_UP)) // force new full new scan
     {
-      beep(50); // beep & debounce
-      delay(KEY_DEBOUNCE); // debounce
+      button_event = BTN_EV_NONE;
+      beep(50); // beep
+      clearScanResults();   // drop results of previous sweeps
       last_state = 255; // force redraw by fake state change ;-)
       channel_sort_idx = CHANNEL_MIN;
       scan_start = 1;
-      FS_BUTTON_DIR = 0;
-
     }
     // update index after channel change
-    current_channel_index = getChannelSortTableEntry(channel_sort_idx);
+    if (scan_revisit_idx >= 0)
+    {
+      current_channel_index = scan_revisit_idx;
+#ifdef slaveSelectPinB
+      scan_channel_index_b = (scan_revisit_idx_b >= 0) ?
+                                       (uint8_t)scan_revisit_idx_b : 0xFF;
+#endif
+    }
+    else
+    {
+      current_channel_index = getChannelSortTableEntry(channel_sort_idx);
+#ifdef slaveSelectPinB
+      const char nextIdx = scan_down_flag ? channel_sort_idx - 1 :
+                                            channel_sort_idx + 1;
+      scan_channel_index_b = (dual_scan_flag && nextIdx >= CHANNEL_MIN &&
+                              nextIdx <= CHANNEL_MAX) ?
+                                     getChannelSortTableEntry(nextIdx) : 0xFF;
+#endif
+    }
   }
 
   /****************************/
@@ -1430,32 +1799,20 @@ void loop()
   if (system_state == STATE_SETUP_MENU)
   {
     // simple menu
-    char menu_id = 0;
-    in_menu = 1;
-    drawScreen.setupMenu();
-#ifdef USE_GC9N_OSD
-    OSDParams[0] = 1; //this is main menu
-    OSDParams[1] = menu_id + 1; //By defaut=lt goes over manual
-    SendToOSD();
-#endif
-    int editing = -1;
-    do {
-      in_menu_time_out = 50;
-      drawScreen.updateSetupMenu(menu_id, settings_beeps, settings_orderby_channel, call_sign, editing);
-      while (--in_menu_time_out && ((digitalRead(buttonMode) == HIGH) && (digitalRead(buttonUp) == HIGH) && (digitalRead(buttonDown) == HIGH)  && fsButtonDirection() == 0)) // wait for next key press or time out
-      {
-        delay(100); // timeout delay
-      }
-
-      if (in_menu_time_out <= 0 ) {
-        system_state = state_last_used;
-        break; // Timed out, Don't save...
-      }
-
-      if (digitalRead(buttonMode) == LOW)       // channel UP
+    const uint8_t menu_event = fetchButtonEvent();
+    if (menu_event == BTN_EV_NONE)
+    {  //no key; check for time out
+      if (millis() - setup_menu_time >= MENU_TIMEOUT_MS)
+        system_state = state_last_used; // Timed out, Don't save...
+    }
+    else
+    {
+      button_event = BTN_EV_NONE;
+      setup_menu_time = millis();
+      if (BTN_EV_BUTTON(menu_event) == BTN_MODE)
       {
         // do something about the users selection
-        switch (menu_id) {
+        switch (setup_menu_id) {
           case 0: // Channel Order Channel/Frequency
             settings_orderby_channel = !settings_orderby_channel;
             break;
@@ -1464,75 +1821,489 @@ void loop()
             break;
 
           case 2:// Edit Call Sign
-            editing++;
-            if (editing > 9) {
-              editing = -1;
+            setup_menu_editing++;
+            if (setup_menu_editing > 9) {
+              setup_menu_editing = -1;
             }
             break;
           case 3:// Calibrate RSSI
-            in_menu = 0;
-            for (uint8_t loop = 0; loop < 10; loop++)
-            {
 #define RSSI_SETUP_BEEP 25
-              beep(RSSI_SETUP_BEEP); // beep & debounce
-              delay(RSSI_SETUP_BEEP); // debounce
-            }
+            beep(RSSI_SETUP_BEEP, RSSI_SETUP_BEEP, 10);
             system_state = STATE_RSSI_SETUP;
             break;
           case 4:
-            in_menu = 0; // save & exit menu
-            system_state = STATE_SAVE;
+            system_state = STATE_SAVE; // save & exit menu
             break;
         }
       }
-      else if (digitalRead(buttonUp) == LOW  || FS_BUTTON_DIR == 1) {
-        if (editing == -1) {
-          menu_id--;
+      else if (BTN_EV_BUTTON(menu_event) == BTN_UP) {
+        if (setup_menu_editing == -1) {
+          setup_menu_id--;
 
         }
         else { // change current letter in place
-          call_sign[editing]++;
-          call_sign[editing] > '}' ? call_sign[editing] = ' ' : false; // loop to oter end
+          char &letter = call_sign[(uint8_t)setup_menu_editing];
+          if (++letter > '}')
+            letter = ' ';     // loop to other end
         }
 
       }
-      else if (digitalRead(buttonDown) == LOW || FS_BUTTON_DIR == 2) {
-        if (editing == -1) {
-          menu_id++;
+      else if (BTN_EV_BUTTON(menu_event) == BTN_DOWN) {
+        if (setup_menu_editing == -1) {
+          setup_menu_id++;
 
 
         }
         else { // change current letter in place
-          call_sign[editing]--;
-          call_sign[editing] < ' ' ? call_sign[editing] = '}' : false; // loop to oter end
+          char &letter = call_sign[(uint8_t)setup_menu_editing];
+          if (--letter < ' ')
+            letter = '}';     // loop to other end
         }
       }
 
-      if (menu_id > 4) {
-        menu_id = 0;
+      if (setup_menu_id > 4) {
+        setup_menu_id = 0;
       }
-      if (menu_id < 0) {
-        menu_id = 4;
+      if (setup_menu_id < 0) {
+        setup_menu_id = 4;
       }
 
 #ifdef USE_GC9N_OSD
       OSDParams[0] = 1; //this is main menu
-      OSDParams[1] = menu_id + 1; //By defaut=lt goes over manual
-      SendToOSD();
+      OSDParams[1] = setup_menu_id + 1; //By defaut=lt goes over manual
+      requestOsdUpdate();
+#endif
+      beep(50); // beep
+      if (system_state == STATE_SETUP_MENU)
+        drawScreen.updateSetupMenu(setup_menu_id, settings_beeps, settings_orderby_channel, call_sign, setup_menu_editing);
+    }
+  }
+
+  // drop any button event not used by the current state
+  button_event = BTN_EV_NONE;
+}
+
+//Sets the tuner to the current channel (if changed).
+void tuneTask()
+{
+  setTunerToCurrentChannel();
+}
+
+//Samples RSSI (which also selects the diversity receiver) once the tuner
+// has settled after a tune, and every RSSI_SAMPLE_MS after that.
+void rssiTask()
+{
+  if (!is_rssi_ready())
+    return;
+  if (!rssi_pending_flag && millis() - rssi_sample_time < RSSI_SAMPLE_MS)
+    return;
+#ifdef slaveSelectPinB
+  if (last_channel_index_b != 0xFF)
+  {  //receivers tuned to different channels (scanning); read separately
+    current_rssi = readRSSI(useReceiverA);
+    current_rssi_b = matchRssiBToA(readRSSI(useReceiverB));
+  }
+  else
+#endif
+  current_rssi = readRSSI();
+  rssi_sample_time = millis();
+  rssi_pending_flag = false;
+  rssi_fresh_flag = true;
+}
+
+#ifdef USE_SPOTTER
+//Spots other channels with the idle receiver while in manual or
+// screensaver mode.
+void spotterTask()
+{
+  updateSpotter((system_state == STATE_MANUAL ||
+                 system_state == STATE_SCREEN_SAVER ||
+                 system_state == STATE_SCREEN_SAVER_LITE)
+#ifdef USE_PRETUNE
+                && getPreTuneChannelIdx() < 0    //idle receiver looks ahead
+#endif
+               );
+}
+#endif
+
+#ifdef USE_PRETUNE
+//Keeps the idle receiver tuned ahead to the next channel while channels
+// are being stepped through in manual mode.
+void preTuneTask()
+{
+  updatePreTune(getPreTuneChannelIdx());
+}
+#endif
+
+//Sends the screen buffer to the display if it was drawn to.
+void displayTask()
+{
+  drawScreen.flush();
+}
+
+#ifdef USE_GC9N_OSD
+//Sends an update to the OSD if one was requested.
+void osdTask()
+{
+  if (osdUpdateFlag)
+  {
+    osdUpdateFlag = false;
+    SendToOSD();
+  }
+}
+
+//Requests that the OSD be updated with the current 'OSDParams' values.
+void requestOsdUpdate()
+{
+  osdUpdateFlag = true;
+}
 #endif
-      beep(50); // beep & debounce
-      do {
-        delay(150);// wait for button release
 
+//Saves a changed channel to EEPROM once CHANNEL_SAVE_DELAY_MS has
+// elapsed, so holding a key does not write EEPROM on every step.
+void eepromTask()
+{
+  static bool chanSaveTimingFlag = false;
+  static unsigned long chanChangedTime = 0;
+  static unsigned long occSavedTime = 0;
+
+  // occupied channels (for seek warm start) saved at most once per
+  //  OCCUPANCY_SAVE_MIN_MS
+  if (occupancy_save_flag && millis() - occSavedTime >= OCCUPANCY_SAVE_MIN_MS)
+  {
+    occupancy_save_flag = false;
+    occSavedTime = millis();
+    saveOccupancyToEeprom();
+  }
+
+  if (!chanChangedSaveFlag)
+  {
+    chanSaveTimingFlag = false;
+    return;
+  }
+  if (!chanSaveTimingFlag)
+  {
+    chanSaveTimingFlag = true;
+    chanChangedTime = millis();
+  }
+  else if (millis() - chanChangedTime >= CHANNEL_SAVE_DELAY_MS)
+  {
+    chanChangedSaveFlag = false;
+    chanSaveTimingFlag = false;
+    saveChannelToEEPROM();
+  }
+}
+
+
+/*###########################################################################*/
+/*******************/
+/*   USER MENUS    */
+/*******************/
+
+//Starts the mode-select menu.  The menu is shown after the mode button
+// is released; if the button is held for a long press then quick save
+// is invoked instead.
+void enterMainMenu()
+{
+  time_screen_saver = 0;
+  beep(50, 50, 2); // beep twice
+
+#ifdef USE_GC9N_OSD
+  OSDParams[0] = 0; //this is main menu
+  OSDParams[1] = 3; //By default goes over manual
+  requestOsdUpdate(); //UPDATE OSD
+#endif
+
+  main_menu_id = last_state_menu_id;
+  // Show Mode Screen
+  if (system_state == STATE_SEEK_FOUND)
+  {
+    system_state = STATE_SEEK;
+  }
+
+  // reset flag so favorites mode will "restart"
+  favModeInProgressFlag = false;
+
+  main_menu_phase = MAIN_MENU_RELEASE_WAIT;
+}
+
+//Leaves the mode-select menu.
+void exitMainMenu()
+{
+  main_menu_phase = MAIN_MENU_INACTIVE;
+  last_state = 255; // force redraw of current screen
+}
+
+//Runs one step of the mode-select menu.
+/*
+  Enter Mode menu
+  Show current mode
+  Change mode by MODE key
+  Any Mode will refresh screen
+  If not MODE changes in 5 seconds, it uses last used mode
+*/
+void updateMainMenu()
+{
+  if (main_menu_phase == MAIN_MENU_RELEASE_WAIT)
+  {  //on entry wait for release (or long press)
+    uint8_t evt;
+    while ((evt=getButtonEvent()) != BTN_EV_NONE)
+    {
+      if (evt == (BTN_EV_LONG | BTN_MODE))
+      {  // user held the mode button and wants to quick save.
+        system_state = STATE_SAVE;
+#ifdef USE_GC9N_OSD
+        OSDParams[0] = -2; //this is save
+        requestOsdUpdate(); //UPDATE OSD
+#endif
+        exitMainMenu();
+        return;
       }
-      while (editing == -1 && (digitalRead(buttonMode) == LOW || digitalRead(buttonUp) == LOW || digitalRead(buttonDown) == LOW || fsButtonDirection() == 1 || fsButtonDirection() == 2));
     }
-    while (in_menu);
+    if (isButtonHeld(BTN_MODE))
+      return;
+
+    if (chanChangedSaveFlag)
+    {  //need to save new channel
+      chanChangedSaveFlag = false;
+      saveChannelToEEPROM();
+    }
+          //if press while manual-mode showing then jump to screen saver:
+    if (system_state == STATE_MANUAL && !fromScreenSaverFlag)
+    {
+      system_state = STATE_SCREEN_SAVER;
+      fromScreenSaverFlag = true;
+      exitMainMenu();
+      return;
+    }
+    showMainMenuItem();
+    main_menu_phase = MAIN_MENU_ACTIVE;
+    return;
   }
 
-  // tune to current channel
-  setTunerToCurrentChannel();
+  // wait for next key press or time out
+  const uint8_t menu_event = fetchButtonEvent();
+  if (menu_event == BTN_EV_NONE && millis() - main_menu_time < MENU_TIMEOUT_MS)
+    return;
+  button_event = BTN_EV_NONE;
 
+  if (menu_event == BTN_EV_NONE || BTN_EV_BUTTON(menu_event) == BTN_MODE)
+  {
+    if (main_menu_id == 8)
+    {
+#ifdef USE_GC9N_OSD
+      settings_OSD = !settings_OSD;
+      writeByteToEeprom(EEPROM_ADR_OSD, settings_OSD);
+      if (settings_OSD == false)
+      {
+        OSDParams[0] = -99; // CLEAR OSD
+        requestOsdUpdate(); //UPDATE OSD
+      }
+      else
+      {
+        OSDParams[0] = 0; // ENABLE OSD AND GO OVER MAIN MENU OSD SELECTION
+        OSDParams[1] = 7; // OSD
+        requestOsdUpdate(); //UPDATE OSD
+      }
+#endif
+      showMainMenuItem();
+    }
+    else
+    {
+      if (menu_event == BTN_EV_NONE)
+      {  //button not pressed; timeout
+        if (state_last_used != STATE_SCAN)
+          system_state = state_last_used; // exit to last state on timeout.
+        else
+        {  //last state was bandscan; resume to manual or byMHz mode
+          system_state = (last_state_menu_id != 3) ? STATE_MANUAL :
+                                                     STATE_FREQ_BYMHZ;
+        }
+      }
+      else  //button pressed; set id for item to be selected when menu resumed
+      {
+        last_state_menu_id = main_menu_tracked_id;
+               //if auto/seek menu item selected then always start new seek
+               // (but if timeout then will depend on 'seek_found')
+        if (system_state == STATE_SEEK)
+        {
+          force_seek = 1;
+          if (seek_found)
+            seek_found = 0;
+          else  //if "new" seek then init 'last-rssi' value
+            last_seek_rssi = 0;
+        }
+      }
+      exitMainMenu(); // EXIT
+      beep(100, 50, 2); // beep twice
+    }
+  }
+  else // no timeout, must be keypressed
+  {
+    /*********************/
+    /*   Menu handler   */
+    /*********************/
+
+    if (BTN_EV_BUTTON(menu_event) == BTN_UP) {
+      main_menu_id--;
+#ifdef USE_DIVERSITY
+      if (!isDiversity() && main_menu_id == 6) { // make sure we back up two menu slots.
+        main_menu_id--;
+      }
+#endif
+#ifndef USE_GC9N_OSD
+      if (main_menu_id == 8) { // no OSD item; back up two menu slots
+        main_menu_id--;
+      }
+#endif
+    }
+    else if (BTN_EV_BUTTON(menu_event) == BTN_DOWN) {
+      main_menu_id++;
+    }
+
+    if (main_menu_id > MAX_MENU_COUNT)
+    {
+      main_menu_id = 0; // next state
+    }
+    if (main_menu_id < 0)
+    {
+      main_menu_id = MAX_MENU_COUNT;
+    }
+
+    beep(50); // beep
+#ifdef USE_GC9N_OSD
+    OSDParams[0] = 0; //this is main menu
+    OSDParams[1] = main_menu_id + 1; //By defaut=lt goes over manual
+    requestOsdUpdate(); //UPDATE OSD
+#endif
+    showMainMenuItem();
+  }
+}
+
+//Sets the state for the selected mode-select menu item and draws the
+// menu.
+void showMainMenuItem()
+{
+  // init tracker for item to be selected when menu resumed later on
+  main_menu_tracked_id = last_state_menu_id;
+
+  switch (main_menu_id)
+  {
+    case 0: // AUTO MODE
+      system_state = STATE_SEEK;
+      main_menu_tracked_id = main_menu_id;
+      break;
+    case 1: // Band Scanner
+      system_state = STATE_SCAN;
+      scan_start = 1;
+      break;
+    case 2: // manual mode
+      system_state = STATE_MANUAL;
+      main_menu_tracked_id = main_menu_id;
+      break;
+    case 3: // Set freq by MHz
+      system_state = STATE_FREQ_BYMHZ;
+      main_menu_tracked_id = main_menu_id;
+      break;
+    case 4: // Favorites Menu       //gc9n
+      system_state = STATE_FAVORITE;       //gc9n
+      main_menu_tracked_id = main_menu_id;
+      break;                        //gc9n
+    case 5: // Setup Menu           //gc9n
+      system_state = STATE_SETUP_MENU;     //gc9n
+      break;                        //gc9n
+#ifdef USE_DIVERSITY
+    case 6: // Diversity
+      if (isDiversity())
+        system_state = STATE_DIVERSITY;
+      else
+      {  // Skip to next menu item
+        main_menu_id++;
+        system_state = STATE_SCREEN_SAVER_LITE;
+      }
+      break;
+#else
+    case 6: // Skip to next menu item
+      main_menu_id++;
+      system_state = STATE_SCREEN_SAVER_LITE;
+      break;
+#endif
+    case 7://Vres modelo            //gc9n
+      system_state = STATE_SCREEN_SAVER_LITE;       //gc9n
+      //drawScreen.updateScreenSaver(rssi);
+      break;
+#ifdef USE_GC9N_OSD
+    case 8:// OSD enable/disable  //gc9n
+      break;                        //gc9n
+#else
+    case 8: // no OSD item; skip to next (watch list)
+      main_menu_id++;
+      system_state = STATE_WATCH;
+      break;
+#endif
+    case 9: // watch list
+      system_state = STATE_WATCH;
+      break;
+  } // end switch
+
+  // draw mode select screen
+  ////Serial.println (systemState);
+  if (main_menu_id > 4)
+  {
+#ifdef USE_GC9N_OSD
+    drawScreen.mainMenuSecondPage(main_menu_id - 5, settings_OSD);
+#else
+    drawScreen.mainMenuSecondPage(main_menu_id - 5, false);
+#endif
+  }
+  else
+  {
+    drawScreen.mainMenu(main_menu_id);
+  }
+  main_menu_time = millis();
+}
+
+//Keeps the current screen showing for the given time (or until a key
+// is pressed) before the user interface continues.
+void holdScreen(uint16_t timeMs)
+{
+  screen_hold_start = millis();
+  screen_hold_ms = timeMs;
+}
+
+//Shows the race-channel plan found by the planner (started by DOWN in
+// the band scanner or serial command 'N') on the display and the serial
+// port.  The current mode's screen is redrawn when the plan screen is
+// closed.
+void showRacePlan()
+{
+  uint8_t freqIdxArr[RACE_PLAN_MAX_PILOTS];
+  uint16_t nameArr[RACE_PLAN_MAX_PILOTS];
+  uint16_t freqArr[RACE_PLAN_MAX_PILOTS];
+  const uint8_t count = getRacePlan(freqIdxArr);
+  Serial.print(F("plan:"));
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    nameArr[i] = channelIndexToName(freqIdxArr[i]);
+    freqArr[i] = getChannelFreqTableEntry(freqIdxArr[i]);
+    Serial.print(' ');
+    Serial.print((char)(nameArr[i] >> 8));
+    Serial.print((char)(nameArr[i] & 0xFF));
+    Serial.print('=');
+    Serial.print(freqArr[i]);
+  }
+  Serial.println();
+  if (count > 0)
+  {
+    Serial.print(F("min spacing: "));
+    Serial.print(getRacePlanMinSpacing());
+    Serial.print(F(", imd: "));
+    Serial.println(getRacePlanImdHits());
+  }
+  drawScreen.racePlan(count, nameArr, freqArr, getRacePlanMinSpacing(),
+                                                      getRacePlanImdHits());
+  holdScreen(10000);
+  force_menu_redraw = 1;
 }
 
 
@@ -1544,8 +2315,16 @@ void loop()
 //Sets the tuner to the value specified by the 'current_channel' variables.
 void setTunerToCurrentChannel()
 {
+#ifdef slaveSelectPinB
+  if (system_state != STATE_SCAN)
+    scan_channel_index_b = 0xFF;       //receiver B follows A
+#endif
   if (current_channel_index != last_channel_index ||
-      current_channel_mhz != last_channel_mhz)
+      current_channel_mhz != last_channel_mhz
+#ifdef slaveSelectPinB
+      || scan_channel_index_b != last_channel_index_b
+#endif
+     )
   {
     if (current_channel_index == tracking_channel_index &&
         current_channel_mhz > 0)
@@ -1554,18 +2333,65 @@ void setTunerToCurrentChannel()
     }
     else
     {  //tune is by freq index (band/channel)
+#ifdef USE_PRETUNE
+      if (switchToPreTunedChannel(current_channel_index,
+                                  getPreTuneChannelIdx()))
+      {  //video switched to receiver already tuned to channel
+      }
+      else
+#endif
+#ifdef slaveSelectPinB
+      if (scan_channel_index_b != 0xFF)
+        setChannelsByIdx(current_channel_index, scan_channel_index_b);
+      else
+#endif
       setChannelByIdx(current_channel_index);
       tracking_channel_index = current_channel_index;
       current_channel_mhz = 0;
     }
     last_channel_index = current_channel_index;
     last_channel_mhz = current_channel_mhz;
+#ifdef slaveSelectPinB
+    last_channel_index_b = scan_channel_index_b;
+#endif
 
     // keep time of tune to make sure that RSSI is stable when required
     set_time_of_tune();
+    rssi_fresh_flag = false;
+    rssi_pending_flag = true;
   }
 }
 
+#ifdef USE_PRETUNE
+//Returns the channel index one step from the current channel in the
+// direction of the last channel change in manual mode (in the same
+// order as UP/DOWN), or -1 if not in manual mode or PRETUNE_HOLD_MS has
+// elapsed since the last change.
+int getPreTuneChannelIdx()
+{
+  if (system_state != STATE_MANUAL || current_channel_mhz > 0 ||
+      pretune_step_time == 0 ||
+      millis() - pretune_step_time >= PRETUNE_HOLD_MS)
+  {
+    return -1;
+  }
+  if (settings_orderby_channel)
+  {
+    if (pretune_up_flag)
+      return (current_channel_index < CHANNEL_MAX_INDEX) ?
+                             current_channel_index + 1 : CHANNEL_MIN_INDEX;
+    return (current_channel_index > CHANNEL_MIN_INDEX) ?
+                             current_channel_index - 1 : CHANNEL_MAX_INDEX;
+  }
+  const uint8_t sortIdx = getChannelSortTableIndex(current_channel_index);
+  if (pretune_up_flag)
+    return getChannelSortTableEntry((sortIdx < CHANNEL_MAX) ? sortIdx + 1 :
+                                                              CHANNEL_MIN);
+  return getChannelSortTableEntry((sortIdx > CHANNEL_MIN) ? sortIdx - 1 :
+                                                            CHANNEL_MAX);
+}
+#endif
+
 //Converts the given channel-index value to a 2-character band/channel
 // text value encoded in a 16-bit integer.
 // Returns a 16-bit integer with the high byte holding the 'band'
@@ -1610,7 +2436,7 @@ void saveChannelToEEPROM()
   if (current_channel_index != lastSavedIdxVal)
   {
     lastSavedIdxVal = current_channel_index;
-    EEPROM.write(EEPROM_ADR_CHANIDX, current_channel_index);
+    writeByteToEeprom(EEPROM_ADR_CHANIDX, current_channel_index);
   }
   if (current_channel_mhz != lastSavedMHzVal)
   {
@@ -1619,15 +2445,12 @@ void saveChannelToEEPROM()
   }
 }
 
-void beep(uint16_t time)
+//Queues a beep (LED flash, plus buzzer if beeps enabled) that is on
+// for 'time'/2 ms, followed by 'pauseMs' ms off, repeated 'count'
+// times.  Returns without waiting; the beeps play in the background.
+void beep(uint16_t time, uint16_t pauseMs, uint8_t count)
 {
-  digitalWrite(led, HIGH);
-  if (settings_beeps) {
-    digitalWrite(buzzer, LOW); // activate beep
-  }
-  delay(time / 2);
-  digitalWrite(led, LOW);
-  digitalWrite(buzzer, HIGH);
+  queueBeep(time / 2, pauseMs, count, settings_beeps);
 }
 
 
@@ -1664,7 +2487,7 @@ bool addFreqOrIdxToFavs(uint16_t fVal)
   if ((idx=getFavIndexForFreqOrIdx(fVal)) >= 0)
   {  //match found; select as current favorite
     currentFavoritesIndex = (uint8_t)idx;
-    EEPROM.write(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
+    writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
     return false;
   }
 
@@ -1693,13 +2516,13 @@ bool addFreqOrIdxToFavs(uint16_t fVal)
   // enter given value into favorites slot
   writeWordToEeprom(EEPROM_ADRA_FAVLIST + (btIdx*(uint16_t)2), fVal);
   currentFavoritesIndex = btIdx;
-  EEPROM.write(EEPROM_ADR_LAST_FAVIDX, btIdx);
+  writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, btIdx);
   return true;
 }
 
 
 //Deletes the current favorite from the list.  Entries after the deleted
-// entry are shifted down.
+// entry (and their watch-list flags) are shifted down.
 // Returns true if the favorites list still contains entries; false if
 //  the list is now empty.
 boolean deleteCurrentFavEntry()
@@ -1725,6 +2548,16 @@ boolean deleteCurrentFavEntry()
     writeWordToEeprom(EEPROM_ADRA_FAVLIST + (idx*2), (uint16_t)0xFFFF);
     currentFavoritesCount = (uint8_t)idx;   //keep track of favs count
 
+    // shift watch-list flags to match; freed slot gets default (watched)
+    const uint16_t lowMask = ((uint16_t)1 << btIdx) - 1;
+    const uint16_t newMask = (watch_mask & lowMask) |
+             ((watch_mask >> 1) & ~lowMask) | ((uint16_t)1 << idx);
+    if (newMask != watch_mask)
+    {
+      watch_mask = newMask;
+      writeWordToEeprom(EEPROM_ADRW_WATCHMASK, watch_mask);
+    }
+
     // if last used slot was deleted then update current favorite index
     if (btIdx == idx)
     {
@@ -1732,12 +2565,12 @@ boolean deleteCurrentFavEntry()
       {  //was on first slot; list is now empty
         currentFavoritesCount = 0;
         currentFavoritesIndex = 0;
-        EEPROM.write(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
+        writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
         return false;
       }
       --btIdx;
       currentFavoritesIndex = btIdx;
-      EEPROM.write(EEPROM_ADR_LAST_FAVIDX, btIdx);
+      writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, btIdx);
     }
   }
   return true;
@@ -1780,7 +2613,7 @@ void nextOrPrevFavEntry(boolean nextFlag)
       btIdx = currentFavoritesCount - (uint8_t)1;
   }
   currentFavoritesIndex = btIdx;
-  EEPROM.write(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
+  writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
 }
 
 
@@ -1851,38 +2684,435 @@ void SendToOSD() //GC9N
 }
 #endif
 
-int8_t fsButtonDirection () //gc9n
+//Fetches the next queued button event into 'button_event' (if the
+// previous event has been consumed) and returns it.  Release and
+// long-press events are skipped (long press is checked where needed).
+// The event stays pending until the code acting on it clears
+// 'button_event', so each event is consumed exactly once.
+uint8_t fetchButtonEvent()
 {
-  char dir; //1 UP 2 DOWN
-  while ( Serial.available() > 0) {
+  if (button_event == BTN_EV_NONE)
+  {
+    processSerialInput();        //Fatshark buttons are queued as events
+    uint8_t evt;
+    while ((evt=getButtonEvent()) != BTN_EV_NONE)
+    {
+      if (BTN_EV_TYPE(evt) != BTN_EV_RELEASE && BTN_EV_TYPE(evt) != BTN_EV_LONG)
+      {
+        button_event = evt;
+        break;
+      }
+    }
+  }
+  return button_event;
+}
+
 
-    dir = Serial.read();
-    if (dir == ']')
+//Processes typed commands received via the serial port.
+void handleSerialCommands()
+{
+  uint8_t cmdCode;
+  uint16_t cmdVal;
+  processSerialInput();
+  while ((cmdCode=getSerialCommand(&cmdVal)) != SCMD_NONE)
+  {
+    if (cmdCode == SCMD_TASK_STATS)
+    {  //report only; no change to mode
+      printTaskStats();
+#ifdef USE_PERF_METRICS
+      printPerfStats();
+#endif
+      continue;
+    }
+    if (cmdCode == SCMD_DIV_LOG)
+    {  //report only; no change to mode
+#ifdef USE_DIVERSITY
+      printDiversityLog();
+#endif
+      continue;
+    }
+    if (cmdCode == SCMD_SCAN_LIST)
+    {  //report only; no change to mode
+      printScanResults();
+      continue;
+    }
+    // command changes mode; leave menu or held screen
+    if (main_menu_phase != MAIN_MENU_INACTIVE)
     {
-      FS_BUTTON_DIR = 2;
-      return 2;
+      exitMainMenu();
+      system_state = state_last_used;
     }
+    screen_hold_ms = 0;
+    endChannelSweep();
+    switch (cmdCode)
+    {
+      case SCMD_TUNE_MHZ:         // tune to frequency in MHz
+        if (cmdVal >= MIN_CHANNEL_MHZ && cmdVal <= MAX_CHANNEL_MHZ)
+        {
+          current_channel_mhz = cmdVal;
+                   //set table index to nearest entry:
+          current_channel_index = freqInMhzToNearestFreqIdx(cmdVal, true);
+          channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+                   //set tracking equal so tune is via 'current_channel_mhz':
+          tracking_channel_index = current_channel_index;
+          setTunerToCurrentChannel();       //tune now so not delayed
+          saveChannelToEEPROM();
+          favModeInProgressFlag = false;
+          system_state = STATE_FREQ_BYMHZ;
+          last_state_menu_id = 3;
+        }
+        break;
+      case SCMD_SEL_FAV:          // select favorite slot (1-based)
+        if (cmdVal > 0 && cmdVal <= currentFavoritesCount)
+        {
+          currentFavoritesIndex = (uint8_t)(cmdVal - 1);
+          writeByteToEeprom(EEPROM_ADR_LAST_FAVIDX, currentFavoritesIndex);
+          setCurrentChannelFromFavEntry(
+                                  getEntryForFavIndex(currentFavoritesIndex));
+          setTunerToCurrentChannel();       //tune now so not delayed
+          favModeInProgressFlag = false;    //restart favorites mode
+          system_state = STATE_FAVORITE;
+          last_state_menu_id = 4;
+        }
+        break;
+      case SCMD_START_SCAN:       // start band scan
+        favModeInProgressFlag = false;
+        system_state = STATE_SCAN;
+        last_state = 255;         // force new scan if already scanning
+        break;
+      case SCMD_RACE_PLAN:        // show race-channel plan
+        startRacePlan((cmdVal > 0) ? (uint8_t)cmdVal : RACE_PLAN_PILOTS);
+        race_plan_flag = true;
+        break;
+      case SCMD_AUTO_TUNE:        // auto fine-tune in Set by MHz mode
+        favModeInProgressFlag = false;
+        system_state = STATE_FREQ_BYMHZ;
+        last_state_menu_id = 3;
+        auto_tune_request_flag = true;
+        break;
+      case SCMD_SEEK_MHZ:         // seek by MHz in Set by MHz mode
+        favModeInProgressFlag = false;
+        system_state = STATE_FREQ_BYMHZ;
+        last_state_menu_id = 3;
+        mhz_seek_request_flag = true;
+        break;
+      case SCMD_FAV_SWEEP:        // rank favorites by RSSI
+        if (currentFavoritesCount > 0)
+        {
+          favModeInProgressFlag = false;
+          state_last_used = STATE_FAVORITE;
+          system_state = STATE_FAV_SWEEP;
+          last_state = 255;       // force new sweep if already sweeping
+          last_state_menu_id = 4;
+        }
+        break;
+      case SCMD_WATCH_LIST:       // watch list of favorites
+        if (cmdVal > 0)
+        {  //set favorites watched
+          watch_mask = cmdVal;
+          writeWordToEeprom(EEPROM_ADRW_WATCHMASK, watch_mask);
+        }
+        favModeInProgressFlag = false;
+        system_state = STATE_WATCH;
+        last_state = 255;         // restart if already watching
+        break;
+      case SCMD_START_SEEK:       // start auto seek
+        favModeInProgressFlag = false;
+        system_state = STATE_SEEK;
+        last_state = 255;         // force redraw if already seeking
+        last_state_menu_id = 0;
+        force_seek = 1;
+        seek_found = 0;
+        last_seek_rssi = 0;
+        break;
+    }
+  }
+}
 
-    else if (dir == '[')
+//Runs the seek by MHz in Set by MHz mode: starts it when requested,
+// then each time the RSSI has been sampled (after the tuner settled)
+// steps up by SEEK_MHZ_STEP (wrapping around the frequency range) until
+// the RSSI rises above the seek threshold, and then starts auto
+// fine-tune to find the peak of the signal.  If the whole range holds
+// no signal then the starting frequency is restored.
+void updateMhzSeek()
+{
+  if ((!mhz_seek_request_flag && !mhz_seek_active_flag) || !rssi_fresh_flag)
+    return;
+  if (mhz_seek_request_flag)
+  {  //first RSSI is at starting frequency
+    mhz_seek_request_flag = false;
+    mhz_seek_active_flag = true;
+    mhz_seek_start_mhz = getCurrentChannelInMhz();
+    mhz_seek_step_count = 0;
+  }
+  else if (current_rssi > getSeekThreshold() &&
+           mhz_seek_last_rssi <= getSeekThreshold())
+  {  //signal found; fine-tune (with this RSSI sample)
+    mhz_seek_active_flag = false;
+    auto_tune_request_flag = true;
+    return;
+  }
+  rssi_fresh_flag = false;
+  mhz_seek_last_rssi = current_rssi;
+  uint16_t freqVal;
+  if (++mhz_seek_step_count >
+                  (MAX_CHANNEL_MHZ - MIN_CHANNEL_MHZ) / SEEK_MHZ_STEP + 1)
+  {  //whole range checked; nothing found
+    mhz_seek_active_flag = false;
+    freqVal = mhz_seek_start_mhz;
+  }
+  else
+  {
+    freqVal = getCurrentChannelInMhz() + SEEK_MHZ_STEP;
+    if (freqVal > MAX_CHANNEL_MHZ)
+      freqVal -= MAX_CHANNEL_MHZ - MIN_CHANNEL_MHZ + 1;
+  }
+  setCurrentChannelMhz(freqVal);
+  screen_saver_shown_flag = false;     //redraw with new frequency
+}
+
+//Runs the auto fine-tune search in Set by MHz mode: starts it when
+// requested, then each time the RSSI has been sampled (after the tuner
+// settled) passes it to the search and tunes the next frequency to be
+// checked, ending on the best frequency found.
+void updateAutoTune()
+{
+  if ((!auto_tune_request_flag && !auto_tune_active_flag) ||
+      !rssi_fresh_flag)
+  {
+    return;
+  }
+  rssi_fresh_flag = false;
+  if (auto_tune_request_flag)
+  {
+    auto_tune_request_flag = false;
+    auto_tune_active_flag = true;
+    auto_tune_start_mhz = getCurrentChannelInMhz();
+    startAutoTune(auto_tune_start_mhz, current_rssi);
+  }
+  else
+    setAutoTuneProbeRssi(current_rssi);
+  uint16_t freqVal = getAutoTuneProbeFreq();
+  if (freqVal == 0)
+  {  //search done; tune to best frequency found
+    auto_tune_active_flag = false;
+    freqVal = getAutoTuneResultFreq();
+    Serial.print(F("AFC: "));
+    Serial.print(auto_tune_start_mhz);
+    Serial.print(F(" -> "));
+    Serial.print(freqVal);
+    Serial.print(F(" rssi "));
+    Serial.println(getAutoTuneResultRssi());
+    chanChangedSaveFlag = true;    //channel changed and needs to be saved
+  }
+  setCurrentChannelMhz(freqVal);
+  screen_saver_shown_flag = false;     //redraw with new frequency
+}
+
+//Stops the seek by MHz or auto fine-tune search (if running), returning
+// to the frequency it started from, and clears the result shown.
+void cancelAutoTune()
+{
+  if (mhz_seek_active_flag)
+  {
+    mhz_seek_active_flag = false;
+    setCurrentChannelMhz(mhz_seek_start_mhz);
+  }
+  if (auto_tune_active_flag)
+  {
+    auto_tune_active_flag = false;
+    setCurrentChannelMhz(auto_tune_start_mhz);
+  }
+  auto_tune_start_mhz = 0;
+}
+
+//Sets the current-channel variables to tune the given frequency in MHz.
+void setCurrentChannelMhz(uint16_t freqVal)
+{
+  current_channel_mhz = freqVal;
+            //set table index to nearest entry:
+  current_channel_index = freqInMhzToNearestFreqIdx(freqVal, true);
+  channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+            //set tracking equal so tune is via 'current_channel_mhz':
+  tracking_channel_index = current_channel_index;
+}
+
+//Returns the sorted-channel index of the next channel (in frequency
+// order) that was occupied last session and has not yet been tried by
+// seek, or -1 if none left.
+char nextWarmSeekChannel()
+{
+  for (char sortIdx = CHANNEL_MIN; sortIdx <= CHANNEL_MAX; ++sortIdx)
+  {
+    const uint8_t idx = getChannelSortTableEntry(sortIdx);
+    const uint8_t maskVal = (uint8_t)1 << (idx % 8);
+    if (seek_warm_bits[idx / 8] & maskVal)
     {
-      FS_BUTTON_DIR = 1;
-      return 1;
+      seek_warm_bits[idx / 8] &= ~maskVal;
+      return sortIdx;
     }
+  }
+  return -1;
+}
 
-    else
-    { FS_BUTTON_DIR = 0;
-      return 0;
+//Updates the occupied-channel bits in EEPROM from the scan results
+// (writing only bytes that changed).
+void saveOccupancyToEeprom()
+{
+  uint8_t bitsArr[OCCUPANCY_BITS_SIZE];
+  for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+    bitsArr[i] = EEPROM.read(EEPROM_ADRA_OCCUPANCY + i);
+  if (!updateOccupancyBits(bitsArr))
+    return;
+  for (uint8_t i = 0; i < OCCUPANCY_BITS_SIZE; ++i)
+  {
+    if (EEPROM.read(EEPROM_ADRA_OCCUPANCY + i) != bitsArr[i])
+      writeByteToEeprom(EEPROM_ADRA_OCCUPANCY + i, bitsArr[i]);
+  }
+}
+
+//Sets the current-channel variables to the given favorites-entry value
+// (frequency index or frequency in MHz) and saves the channel to EEPROM.
+void setCurrentChannelFromFavEntry(int fVal)
+{
+  if (fVal < 0)
+    return;
+  setChannelVarsFromFavEntry(fVal);
+  saveChannelToEEPROM();
+}
+
+//Sets the 'current_channel' variables from the given favorites entry
+// (frequency index or frequency in MHz), without saving to EEPROM.
+void setChannelVarsFromFavEntry(int fVal)
+{
+  if (fVal < 0)
+    return;
+  if (fVal <= 255)
+  {  //frequency index
+    current_channel_index = (uint8_t)fVal;
+    current_channel_mhz = 0;
+    channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+  }
+  else
+  {  //frequency in MHz
+    current_channel_mhz = fVal;
+              //set table index to nearest entry:
+    current_channel_index = freqInMhzToNearestFreqIdx(current_channel_mhz, true);
+    channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+              //set tracking equal so tune is via 'current_channel_mhz':
+    tracking_channel_index = current_channel_index;
+  }
+}
+
+//Ranks the favorites by the RSSI measured on each (strongest first) and
+// shows the ranking, with the cursor at 'fav_sweep_sel'.
+void showFavSweepRanking()
+{
+  uint8_t favNums[FAV_NUMBER_OF_SLOTS];
+  uint16_t freqs[FAV_NUMBER_OF_SLOTS];
+  uint8_t rssis[FAV_NUMBER_OF_SLOTS];
+  const uint8_t count = currentFavoritesCount;
+  uint8_t i, j;
+  for (i = 0; i < count; ++i)
+  {  //insertion sort by RSSI (stable, so ties keep list order)
+    j = i;
+    while (j > 0 && fav_sweep_rssi[fav_sweep_rank[j-1]] < fav_sweep_rssi[i])
+    {
+      fav_sweep_rank[j] = fav_sweep_rank[j-1];
+      --j;
     }
+    fav_sweep_rank[j] = i;
+  }
+  for (i = 0; i < count; ++i)
+  {
+    const uint8_t favIdx = fav_sweep_rank[i];
+    const int fVal = getEntryForFavIndex(favIdx);
+    favNums[i] = favIdx + 1;
+    freqs[i] = (fVal <= 255) ? getChannelFreqTableEntry(fVal) : fVal;
+    rssis[i] = fav_sweep_rssi[favIdx];
   }
-  return 0;
+  drawScreen.favSweep(count, favNums, freqs, rssis, fav_sweep_sel);
 }
 
+//Returns the index of the next favorite after the given one (wrapping
+// around) that is in the watch list, or -1 if none are.
+int nextWatchIndex(int favIdx)
+{
+  for (uint8_t i = 0; i < currentFavoritesCount; ++i)
+  {
+    if (++favIdx >= currentFavoritesCount)
+      favIdx = 0;
+    if (watch_mask & ((uint16_t)1 << favIdx))
+      return favIdx;
+  }
+  return -1;
+}
+
+//Shows the RSSI bars for the favorites in the watch list.
+void showWatchList()
+{
+  uint8_t rssis[WATCH_MAX_CHANNELS];
+  uint8_t minRssis[WATCH_MAX_CHANNELS];
+  uint8_t maxRssis[WATCH_MAX_CHANNELS];
+  for (uint8_t i = 0; i < currentFavoritesCount; ++i)
+  {
+    rssis[i] = getWatchRssi(i);
+    minRssis[i] = getWatchMinRssi(i);
+    maxRssis[i] = getWatchMaxRssi(i);
+  }
+  drawScreen.watchList(currentFavoritesCount, rssis, minRssis, maxRssis,
+                       watch_mask, watch_sel, getWatchRefreshMs());
+  watch_redraw_flag = false;
+}
+
+//Saves the current channel, to be set again by 'endChannelSweep()' when
+// a mode that tunes through other channels (favorites sweep, watch
+// list) is left.
+void startChannelSweep()
+{
+  sweep_restore_flag = true;
+  sweep_restore_idx = current_channel_index;
+  sweep_restore_mhz = current_channel_mhz;
+}
+
+//Ends the favorites sweep or watch list (if running), setting the
+// channel back to the one saved by 'startChannelSweep()'.
+void endChannelSweep()
+{
+  if (!sweep_restore_flag)
+    return;
+  sweep_restore_flag = false;
+  current_channel_index = sweep_restore_idx;
+  current_channel_mhz = sweep_restore_mhz;
+  channel_sort_idx = getChannelSortTableIndex(current_channel_index);
+         //set tracking equal so tune is via 'current_channel_mhz' (if set):
+  tracking_channel_index = current_channel_index;
+}
+
+
+//Rebuilds the RSSI calibration curves from the current min, floor and
+// max values.
+void updateRssiCalCurves()
+{
+  setRssiCalRange(RSSI_CAL_RCVR_A, rssi_min_a, rssi_floor_a, rssi_max_a);
+#ifdef USE_DIVERSITY
+  setRssiCalRange(RSSI_CAL_RCVR_B, rssi_min_b, rssi_floor_b, rssi_max_b);
+#endif
+}
 
 //Writes 2-byte word to EEPROM at address.
 void writeWordToEeprom(int addr, uint16_t val)
 {
-  EEPROM.write(addr, lowByte(val));
-  EEPROM.write(addr+1, highByte(val));
+  writeByteToEeprom(addr, lowByte(val));
+  writeByteToEeprom(addr+1, highByte(val));
+}
+
+//Writes byte to EEPROM at address.
+void writeByteToEeprom(int addr, uint8_t val)
+{
+  EEPROM.write(addr, val);
+  PERF_COUNT(PERF_CNT_EEPROM_WRITES);
 }
 
 //Reads 2-byte word at address from EEPROM.
@@ -43,6 +43,7 @@ class screens
         uint8_t last_channel;
         uint16_t bestChannelName;
         uint16_t bestChannelFrequency;
+        bool displayDirtyFlag;
         void reset();
         void drawTitleBox(const char *title, bool centerFlag = true);
 
@@ -50,6 +51,8 @@ class screens
         screens();
         char begin(const char *call_sign);
         void flip();
+        bool isDirty();
+        void flush();
 
         // MAIN MENU
         void mainMenu(uint8_t menu_id);
@@ -64,21 +67,32 @@ class screens
         void NoFav(); // fav
         void FavDelete( uint16_t channelFrequency, uint8_t channel);
         void FavSel(uint8_t favchan); // fav
+        void favSweep(uint8_t count, const uint8_t *favNums, const uint16_t *freqs, const uint8_t *rssis, uint8_t selPos); // favorites ranked by RSSI
         //void FavReorg(uint8_t favchan); // fav
         
         // BAND SCAN
         void bandScanMode(uint8_t state);
         void updateBandScanMode(bool in_setup, uint8_t channel, uint8_t rssi, uint16_t channelName, uint16_t channelFrequency, uint16_t rssi_setup_min_a, uint16_t rssi_setup_max_a);
+        void updateBandScanImdFlag(uint8_t channel, bool imdFlag);
+        void bandScanSweepDone();
+        void updateBandScanBar(uint8_t channel, uint8_t rssi);
+
+        // WATCH LIST
+        void watchList(uint8_t count, const uint8_t *rssis, const uint8_t *minRssis, const uint8_t *maxRssis, uint16_t watchMask, uint8_t selPos, uint16_t refreshMs);
+
+        // RACE CHANNEL PLAN
+        void racePlan(uint8_t count, const uint16_t *channelNames, const uint16_t *channelFreqs, uint16_t minSpacing, uint8_t imdHits);
 
         // SCREEN SAVER
         void screenSaver(uint16_t channelName, uint16_t channelFrequency, const char *call_sign);
         void screenSaver(uint8_t diversity_mode, uint16_t channelName, uint16_t channelFrequency, const char *call_sign);
         void updateScreenSaver(uint8_t rssi);
         void updateScreenSaver(char active_receiver, uint8_t rssi, uint8_t rssiA, uint8_t rssiB ); // diversity
+        void screenSaverAutoTune(int offsetMhz); // auto fine-tune result
 
         // DIVERSITY
         void diversity(uint8_t diversity_mode);
-        void updateDiversity(char active_receiver, uint8_t rssiA, uint8_t rssiB);
+        void updateDiversity(char active_receiver, uint8_t rssiA, uint8_t rssiB, uint8_t switchesPerMin);
 
         // SETUP MENU
         void setupMenu();
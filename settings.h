@@ -50,6 +50,10 @@ SOFTWARE.
 // uncomment to enable OSD support by GC9N
 //#define USE_GC9N_OSD
 
+// uncomment to count retunes, display updates and EEPROM writes and to
+// time seek lock and scan sweeps (reported by serial command 'P')
+//#define USE_PERF_METRICS
+
 //#define USE_FLIP_SCREEN
 #define USE_BOOT_LOGO
 
@@ -81,6 +85,9 @@ SOFTWARE.
     #define rssiPinB A7
     #define useReceiverAuto 0
     #define useReceiverB 2   
+    // like auto, but also switches early when active receiver is fading
+    // and predicted to drop below the other one
+    #define useReceiverPredict 3
     // rssi strength should be 2% greater than other receiver before switch.
     // this prevents flicker when rssi values are close and delays diversity checks counter.
     
@@ -91,6 +98,43 @@ SOFTWARE.
 
     // 1 to 10 is a good range. 1 being fast switching, 10 being slow 100ms to switch.
     #define DIVERSITY_MAX_CHECKS 7 //changing this to 7 try making it smoother eliminate sync problems.
+
+    // predictive mode: number of RSSI samples (about 10ms each) ahead
+    // that the RSSI trend is projected when checking for a crossover
+    #define DIVERSITY_PREDICT_SAMPLES 5
+    // predictive mode: min rate of RSSI fall (percent per sample, x16)
+    // before an early switch is considered; ignores noise
+    #define DIVERSITY_PREDICT_MIN_SLOPE 16
+
+    // if the select (LE) line of receiver B is wired to its own pin
+    // (instead of sharing 'slaveSelectPin') then the band scanner tunes
+    // the two receivers to different channels, halving the sweep time
+    //#define slaveSelectPinB 8
+
+    // spotter (needs slaveSelectPinB): in manual and screensaver modes
+    // the idle receiver is briefly tuned to each other channel in turn,
+    // adding to the scan results (serial command 'L') to show who else
+    // is transmitting; video stays on the active receiver (spotter and
+    // look-ahead run only with DIVERSITY set to AUTO or PREDICT)
+    //#define USE_SPOTTER
+    // time between channels spotted; diversity switching is held for
+    // about 2*MIN_TUNE_TIME of each interval
+    #define SPOTTER_INTERVAL_MS 250
+
+    // look-ahead (needs slaveSelectPinB): after an UP/DOWN channel change
+    // in manual mode the idle receiver is tuned to the next channel in
+    // the same direction, so the next press switches the video to an
+    // already-settled receiver; diversity switching (and the spotter) is
+    // held until PRETUNE_HOLD_MS after the last channel change
+    //#define USE_PRETUNE
+    #define PRETUNE_HOLD_MS 3000
+#endif
+
+#if defined USE_SPOTTER && !defined slaveSelectPinB
+  #error "USE_SPOTTER requires slaveSelectPinB"
+#endif
+#if defined USE_PRETUNE && !defined slaveSelectPinB
+  #error "USE_PRETUNE requires slaveSelectPinB"
 #endif
 
 // this two are minimum required
@@ -102,24 +146,98 @@ SOFTWARE.
 // Buzzer
 #define buzzer 6
 
-// key debounce delay in ms
-// NOTE: good values are in the range of 100-200ms
-// shorter values will make it more reactive, but may lead to double trigger
+// buttons are sampled from a timer interrupt every BUTTON_SAMPLE_MS and
+// must read the same for BUTTON_DEBOUNCE_SAMPLES samples to change state
+#define BUTTON_SAMPLE_MS 5
+#define BUTTON_DEBOUNCE_SAMPLES 4
+// hold time in ms for long press (mode button held = quick save)
+#define BUTTON_LONG_PRESS_MS 1000
+// UP and DOWN pressed within this many ms of each other are reported as
+// a single UP+DOWN press; a lone UP or DOWN press is reported after
+// this delay (or on release, if sooner)
+#define BUTTON_COMBO_MS 100
+
+// key auto-repeat delay in ms (time held before first repeat)
+// NOTE: good values are in the range of 100-250ms
+// shorter values will make it more reactive, but may lead to unwanted repeats
 #define KEY_DEBOUNCE 200
+// auto-repeat interval is reduced by this much (ms) on each repeat...
+#define KEY_REPEAT_ACCEL 20
+// ...down to this minimum interval (ms)
+#define KEY_REPEAT_MIN 20
+// number of repeats at minimum interval before "fast" repeats are reported
+#define KEY_REPEAT_FAST_COUNT 20
 
 #define led 13
-// number of analog rssi reads to average for the current check.
+// filter applied to RSSI samples from the ADC:
+//  RSSI_FILTER_BOXCAR - average of last RSSI_READS samples
+//  RSSI_FILTER_EMA    - exponential moving average (alpha = 1/2^RSSI_EMA_SHIFT)
+//  RSSI_FILTER_MEDIAN - median of last 5 samples (rejects ADC spikes)
+#define RSSI_FILTER_BOXCAR 1
+#define RSSI_FILTER_EMA 2
+#define RSSI_FILTER_MEDIAN 3
+#define RSSI_FILTER RSSI_FILTER_MEDIAN
+// EMA shift (1..5); higher is smoother but slower
+#define RSSI_EMA_SHIFT 2
+// number of analog rssi reads taken for the first check after tuning
+// (also the boxcar-filter length)
 #define RSSI_READS 10
+// number of analog rssi reads added to the filter for each later check
+#define RSSI_READS_PER_CHECK 2
 // RSSI default raw range
 #define RSSI_MIN_VAL 90
 #define RSSI_MAX_VAL 220
+// the noise floor measured by the RSSI setup sweep (average reading on
+// empty channels) is scaled to this percent, with readings below it
+// squeezed under it; above it the scale is linear up to the max, so the
+// RSSI thresholds below mean the same as with a plain min/max scale
+#define RSSI_CAL_FLOOR_PCT 5
 // 75% threshold, when channel is printed in spectrum
 #define RSSI_SEEK_FOUND 50
 // RSSI value for channel found during auto-seek
 #define RSSI_SEEK_TRESHOLD 60
+// after each seek sweep the found-channel threshold is set to the noise
+// floor (median RSSI of all channels) plus this margin, limited to the
+// given range (RSSI_SEEK_TRESHOLD is used until a sweep is done)
+#define RSSI_SEEK_MARGIN 30
+#define RSSI_SEEK_TRESHOLD_MIN 30
+#define RSSI_SEEK_TRESHOLD_MAX 85
 // scan loops for setup run
 #define RSSI_SETUP_RUN 3
 
+// band scanner measures an occupied or changing (RSSI moved by at least
+// SCAN_REVISIT_CHANGE) channel again after every SCAN_REVISIT_INTERVAL
+// channels of the sweep, so a sweep takes up to 1/SCAN_REVISIT_INTERVAL
+// longer but busy channels are updated several times per sweep
+#define SCAN_REVISIT_INTERVAL 4
+#define SCAN_REVISIT_CHANGE 15
+
+// race-channel planner (serial command 'N<pilots>', or press DOWN in
+// the band scanner to plan for RACE_PLAN_PILOTS pilots)
+#define RACE_PLAN_PILOTS 4
+// a third-order intermodulation product (2*f1-f2) lands on a channel if
+// within this many MHz of it
+#define IMD_PRODUCT_MHZ 10
+// band scanner flags a channel as an IMD product of two stronger
+// carriers only if its RSSI is at least this (percent)
+#define IMD_DETECT_MIN_RSSI 25
+// planner: an IMD product landing on a chosen channel counts as a hit,
+// which adds RACE_PLAN_IMD_PENALTY to the cost (cost is otherwise the
+// RSSI percent measured on the chosen channels)
+#define RACE_PLAN_IMD_PENALTY 50
+// added cost for a channel already occupied (RSSI above seek threshold)
+#define RACE_PLAN_BUSY_PENALTY 100
+// channel sets with min spacing up to this many MHz below the best
+// possible are considered (1 cost per MHz lost); larger values search
+// longer
+#define RACE_PLAN_SPACING_SLACK 20
+// cost for a channel the scanner has not measured yet (in place of its
+// RSSI), so measured quiet channels are preferred
+#define RACE_PLAN_UNSCANNED_COST 50
+// planner search steps (channels tried) per user-interface pass, so the
+// search does not hold up RSSI reads
+#define RACE_PLAN_STEPS_PER_CALL 16
+
 #define STATE_SEEK_FOUND 0
 #define STATE_SEEK 1
 #define STATE_SCAN 2
@@ -134,7 +252,9 @@ SOFTWARE.
 #define STATE_SCREEN_SAVER 9
 #define STATE_FAVORITE 10 //gc9n
 #define STATE_SCREEN_SAVER_LITE 11
-#define STATE_MAX_VALUE STATE_SCREEN_SAVER_LITE
+#define STATE_FAV_SWEEP 12   // favorites ranked by RSSI
+#define STATE_WATCH 13       // watch list (RSSI of chosen favorites)
+#define STATE_MAX_VALUE STATE_WATCH
 
 #define START_STATE STATE_SEEK
 
@@ -149,17 +269,24 @@ SOFTWARE.
     #define CHANNEL_MAX_INDEX 39
 #endif
 
+// a tune to a nearby frequency settles sooner: the wait before RSSI is
+// read goes from MIN_TUNE_TIME_NEAR (for a hop of 0 MHz) up to
+// MIN_TUNE_TIME (for hops of TUNE_HOP_FAR_MHZ or more); the near time
+// must not be below the module's minimum tune time
 #ifdef rx5808
     // rx5808 module need >20ms to tune.
     // 25 ms will do a 40 channel scan in 1 second.
     // 35 ms will do a 40 channel scan in 1.4 seconds.
     #define MIN_TUNE_TIME 35
+    #define MIN_TUNE_TIME_NEAR 25
 #endif
 #ifdef rx5880
     // rx5880 module needs >30ms to tune.
     // 35 ms will do a 40 channel scan in 1.4 seconds.
     #define MIN_TUNE_TIME 35
+    #define MIN_TUNE_TIME_NEAR 32
 #endif
+#define TUNE_HOP_FAR_MHZ 100
 
 #ifdef USE_LBAND
     #define CHANNEL_MAX 47
@@ -171,6 +298,27 @@ SOFTWARE.
 #define MIN_CHANNEL_MHZ 5000      //min MHz value for Set by MHz mode
 #define MAX_CHANNEL_MHZ 5999      //max MHz value for Set by MHz mode
 
+// auto fine-tune in Set by MHz mode (press UP and DOWN together, or
+// serial command 'U') searches for the best RSSI within this many MHz
+// of the current frequency (10 MHz takes 5 tunes)
+#define AUTO_TUNE_RANGE_MHZ 10
+
+// seek by MHz (press UP and DOWN together in auto-seek mode, or serial
+// command 'M') steps through MIN_CHANNEL_MHZ..MAX_CHANNEL_MHZ by about
+// the receiver's IF bandwidth (so a VTX between steps is still seen),
+// then fine-tunes on the signal found; 20 MHz takes 50 steps, about
+// the time of a channel-table seek with its longer hops
+#define SEEK_MHZ_STEP 20
+
+// watch list (menu item WATCH LIST, or serial command 'W<mask>') tunes
+// to each chosen favorite in turn for WATCH_SLOT_MS, or longer if the
+// settle time and display transfers delay its RSSI sample (a slot ends
+// only once sampled), so the refresh time shown on screen is measured
+// per round; RSSI on each is averaged over visits
+// (alpha = 1/2^WATCH_FILTER_SHIFT)
+#define WATCH_SLOT_MS 50
+#define WATCH_FILTER_SHIFT 1
+
 #ifdef USE_DIVERSITY
 // used to figure out if diversity module has been plugged in.
 // When RSSI is plugged in the min value is around 90